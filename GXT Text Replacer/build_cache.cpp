@@ -0,0 +1,342 @@
+#include "build_cache.h"
+#include "gxt_text_replacer.h"
+#include "utility.h"
+#include "platform.h"
+#include "build_stats.h"
+#include "diagnostic_log.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+    const std::array<const char, 4> CACHE_HEADER = { 'G', 'X', 'T', 'C' };
+
+    template<typename T>
+    bool ReadValue(std::ifstream& inputStream, T& value)
+    {
+        return static_cast<bool>(inputStream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    template<typename T>
+    void WriteValue(std::ofstream& outputStream, const T& value)
+    {
+        outputStream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+}
+
+BuildCache::BuildCache(std::wstring cacheFileName, std::wstring textSourceDirectory, GXTEnum::eGXTVersion fileVersion,
+    GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage)
+    : _cacheFileName(std::move(cacheFileName)), _textSourceDirectory(std::move(textSourceDirectory))
+{
+    _settingsDigest = ComputeSettingsDigest(fileVersion, textConvertingMode, ansiCodePage);
+}
+
+uint64_t BuildCache::ComputeSettingsDigest(GXTEnum::eGXTVersion fileVersion, GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage)
+{
+    namespace fs = std::filesystem;
+
+    const uint32_t settings[] = { CACHE_FORMAT_VERSION, static_cast<uint32_t>(fileVersion), static_cast<uint32_t>(textConvertingMode), static_cast<uint32_t>(ansiCodePage) };
+    uint64_t digest = Digest::Compute(settings, sizeof(settings));
+
+    // The character map is read from the working directory by BulkReplaceText
+    if (textConvertingMode == GXTEnum::eTextConvertingMode::UseCharacterMap && fs::exists(L"charmap.txt"))
+    {
+        digest = Digest::ComputeFile(L"charmap.txt", digest);
+    }
+
+    return digest;
+}
+
+uint64_t BuildCache::GetInputDigest(const FixedName8& tableName)
+{
+    namespace fs = std::filesystem;
+
+    auto cachedDigest = _inputDigests.find(tableName);
+    if (cachedDigest != _inputDigests.end())
+    {
+        return cachedDigest->second;
+    }
+
+    const std::wstring textDirectory(_textSourceDirectory + Platform::PATH_SEPARATOR + Encoding::AnsiStringToWString(tableName.ToString()));
+
+    // Tables without a text directory are never replaced
+    uint64_t digest = 0;
+    if (Directory::Exists(textDirectory))
+    {
+        std::vector<fs::path> textFiles;
+        for (auto & p : fs::directory_iterator(Platform::ToPath(textDirectory)))
+        {
+            if (p.path().extension() == ".txt")
+            {
+                textFiles.push_back(p.path());
+            }
+        }
+
+        // directory_iterator doesn't guarantee any order
+        std::sort(textFiles.begin(), textFiles.end());
+
+        digest = Digest::INITIAL_VALUE;
+        for (const auto& textFile : textFiles)
+        {
+            digest = Digest::Compute(textFile.filename().string(), digest);
+            digest = Digest::ComputeFile(Platform::FromPath(textFile), digest);
+        }
+    }
+
+    _inputDigests.emplace(tableName, digest);
+    return digest;
+}
+
+void BuildCache::Load()
+{
+    _tableRecords.clear();
+    _convertedEntries.clear();
+    _buildNumber = 0;
+
+    std::ifstream inputFile(Platform::ToPath(_cacheFileName), std::ifstream::binary);
+    if (!inputFile.is_open())
+    {
+        return;
+    }
+    GXT_STATS_ADD(CounterFilesOpened, 1);
+
+    std::array<char, 4> headerBuf;
+    uint32_t formatVersion = 0;
+    uint64_t settingsDigest = 0;
+    uint32_t buildNumber = 0;
+    uint32_t tableCount = 0;
+
+    if (!inputFile.read(headerBuf.data(), headerBuf.size()) || !std::equal(headerBuf.cbegin(), headerBuf.cend(), CACHE_HEADER.cbegin())
+        || !ReadValue(inputFile, formatVersion) || formatVersion != CACHE_FORMAT_VERSION
+        || !ReadValue(inputFile, settingsDigest) || !ReadValue(inputFile, buildNumber) || !ReadValue(inputFile, tableCount))
+    {
+        return;
+    }
+
+    // Conversion settings changed, every table has to be rebuilt
+    if (settingsDigest != _settingsDigest)
+    {
+        return;
+    }
+
+    _buildNumber = buildNumber + 1;
+
+    for (uint32_t i = 0; i < tableCount; i++)
+    {
+        std::array<char, FixedName8::SIZE> tableName;
+        TableRecord record;
+        uint32_t outputBlockSize = 0;
+
+        if (!inputFile.read(tableName.data(), tableName.size())
+            || !ReadValue(inputFile, record.inputDigest)
+            || !ReadValue(inputFile, record.sourceDigest)
+            || !ReadValue(inputFile, record.outputDigest)
+            || !ReadValue(inputFile, outputBlockSize))
+        {
+            _tableRecords.clear();
+            return;
+        }
+
+        record.outputBlock.resize(outputBlockSize);
+        if (outputBlockSize != 0 && !inputFile.read(&record.outputBlock[0], outputBlockSize))
+        {
+            _tableRecords.clear();
+            return;
+        }
+
+        _tableRecords[FixedName8::Read(tableName.data())] = std::move(record);
+    }
+
+    uint32_t entryCount = 0;
+    if (!ReadValue(inputFile, entryCount))
+    {
+        _tableRecords.clear();
+        return;
+    }
+
+    _convertedEntries.reserve(entryCount);
+    for (uint32_t i = 0; i < entryCount; i++)
+    {
+        uint64_t entryDigest = 0;
+        ConvertedEntry entry;
+        uint32_t textSize = 0;
+
+        if (!ReadValue(inputFile, entryDigest) || !ReadValue(inputFile, entry.lastUsedBuild) || !ReadValue(inputFile, textSize))
+        {
+            _tableRecords.clear();
+            _convertedEntries.clear();
+            return;
+        }
+
+        entry.convertedText.resize(textSize);
+        if (textSize != 0 && !inputFile.read(&entry.convertedText[0], textSize))
+        {
+            _tableRecords.clear();
+            _convertedEntries.clear();
+            return;
+        }
+
+        _convertedEntries.emplace(entryDigest, std::move(entry));
+    }
+}
+
+void BuildCache::Save()
+{
+    std::ofstream outputFile(Platform::ToPath(_cacheFileName), std::ofstream::binary);
+    if (!outputFile.is_open())
+    {
+        std::wcerr << L"WARNING: Can't write the build cache " << _cacheFileName << L"!\n";
+        return;
+    }
+    GXT_STATS_ADD(CounterFilesOpened, 1);
+
+    outputFile.write(CACHE_HEADER.data(), CACHE_HEADER.size());
+    WriteValue(outputFile, static_cast<uint32_t>(CACHE_FORMAT_VERSION));
+    WriteValue(outputFile, _settingsDigest);
+    WriteValue(outputFile, _buildNumber);
+    WriteValue(outputFile, static_cast<uint32_t>(_tableRecords.size()));
+
+    for (const auto& pair : _tableRecords)
+    {
+        outputFile.write(pair.first.ToBytes().data(), FixedName8::SIZE);
+        WriteValue(outputFile, pair.second.inputDigest);
+        WriteValue(outputFile, pair.second.sourceDigest);
+        WriteValue(outputFile, pair.second.outputDigest);
+        WriteValue(outputFile, static_cast<uint32_t>(pair.second.outputBlock.size()));
+        outputFile.write(pair.second.outputBlock.data(), pair.second.outputBlock.size());
+    }
+
+    for (auto itr = _convertedEntries.begin(); itr != _convertedEntries.end();)
+    {
+        if (_buildNumber - itr->second.lastUsedBuild > ENTRY_RETENTION_BUILDS)
+        {
+            itr = _convertedEntries.erase(itr);
+        }
+        else
+        {
+            ++itr;
+        }
+    }
+
+    WriteValue(outputFile, static_cast<uint32_t>(_convertedEntries.size()));
+    for (const auto& pair : _convertedEntries)
+    {
+        WriteValue(outputFile, pair.first);
+        WriteValue(outputFile, pair.second.lastUsedBuild);
+        WriteValue(outputFile, static_cast<uint32_t>(pair.second.convertedText.size()));
+        outputFile.write(pair.second.convertedText.data(), pair.second.convertedText.size());
+    }
+}
+
+uint64_t BuildCache::ComputeEntryDigest(uint32_t entryHash, const std::string& utf8Text, size_t characterSize)
+{
+    // The same text converts to different bytes for 8-bit and 16-bit tables
+    const uint32_t keyValues[] = { entryHash, static_cast<uint32_t>(characterSize) };
+    return Digest::Compute(utf8Text, Digest::Compute(keyValues, sizeof(keyValues)));
+}
+
+const std::string* BuildCache::FindConvertedEntry(uint64_t entryDigest)
+{
+    auto itr = _convertedEntries.find(entryDigest);
+    if (itr == _convertedEntries.end())
+    {
+        return nullptr;
+    }
+
+    itr->second.lastUsedBuild = _buildNumber;
+    return &itr->second.convertedText;
+}
+
+void BuildCache::StoreConvertedEntry(uint64_t entryDigest, const std::string& convertedText)
+{
+    ConvertedEntry& entry = _convertedEntries[entryDigest];
+    entry.lastUsedBuild = _buildNumber;
+    entry.convertedText = convertedText;
+}
+
+bool BuildCache::FindReusableBlock(const FixedName8& tableName, uint64_t sourceDigest, std::string& sourceBlock)
+{
+    auto itr = _tableRecords.find(tableName);
+    if (itr == _tableRecords.end())
+    {
+        return false;
+    }
+
+    const TableRecord& record = itr->second;
+    if (record.inputDigest != GetInputDigest(tableName))
+    {
+        return false;
+    }
+
+    // The source is the output of the last build (the GXT file is overwritten in place)
+    if (sourceDigest == record.outputDigest)
+    {
+        return true;
+    }
+
+    // The source is the same original file the last build started from
+    if (sourceDigest == record.sourceDigest)
+    {
+        if (!record.outputBlock.empty())
+        {
+            sourceBlock = record.outputBlock;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void BuildCache::Update(GXTTableCollection& tableCollection, DiagnosticLog& log)
+{
+    std::map<FixedName8, TableRecord> newRecords;
+
+    auto updateRecord = [&](GXTTableBlockInfo& tableInfo)
+    {
+        if (tableInfo.IsSpliced())
+        {
+            auto itr = _tableRecords.find(tableInfo._tableName);
+            if (itr != _tableRecords.end())
+            {
+                newRecords[tableInfo._tableName] = std::move(itr->second);
+            }
+            return;
+        }
+
+        // A spliced table wouldn't load its text files, so their problems wouldn't be logged
+        if (log.GetRecordCount(tableInfo._tableName.ToString()) != 0)
+        {
+            return;
+        }
+
+        std::ostringstream blockStream(std::ios_base::binary);
+        tableInfo.WriteOutBlock(blockStream);
+
+        TableRecord record;
+        record.inputDigest = GetInputDigest(tableInfo._tableName);
+        record.sourceDigest = tableInfo._sourceDigest;
+        record.outputBlock = blockStream.str();
+        record.outputDigest = Digest::Compute(record.outputBlock);
+
+        if (record.outputDigest == record.sourceDigest)
+        {
+            record.outputBlock.clear();
+        }
+
+        newRecords[tableInfo._tableName] = std::move(record);
+    };
+
+    updateRecord(tableCollection.GetMainTable());
+    for (auto& missionTable : tableCollection.GetMissionTableMap())
+    {
+        updateRecord(*missionTable.second);
+    }
+
+    _tableRecords = std::move(newRecords);
+}
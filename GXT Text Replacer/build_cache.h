@@ -0,0 +1,69 @@
+#pragma once
+
+#include "enum.h"
+#include "fixed_name.h"
+
+#include <string>
+#include <map>
+#include <unordered_map>
+
+class GXTTableCollection;
+class DiagnosticLog;
+
+// Persisted per-table record of the last build, stored in <name>_replace.cache next to the GXT file and <name>_replace.log.
+// A table whose text directory and source bytes did not change since the last build is spliced into
+// the output as-is, so it's neither parsed nor replaced again.
+// The cache also keeps the converted bytes of every entry text, so only new or edited entries of a changed
+// table go through the ANSI or character map conversion.
+// Tables whose text files had problems aren't recorded, so they are rebuilt and their problems logged again every time.
+class BuildCache
+{
+public:
+    BuildCache(std::wstring cacheFileName, std::wstring textSourceDirectory, GXTEnum::eGXTVersion fileVersion,
+        GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage);
+
+    void Load();
+    void Save();
+
+    // Returns true and replaces the content of sourceBlock with the block to write out if the table can be reused
+    bool FindReusableBlock(const FixedName8& tableName, uint64_t sourceDigest, std::string& sourceBlock);
+    // Records the tables of the collection that has just been written out, except those the log has records for
+    void Update(GXTTableCollection& tableCollection, DiagnosticLog& log);
+
+    static uint64_t ComputeEntryDigest(uint32_t entryHash, const std::string& utf8Text, size_t characterSize);
+    // Returns nullptr if the entry text hasn't been converted in the recent builds
+    const std::string* FindConvertedEntry(uint64_t entryDigest);
+    void StoreConvertedEntry(uint64_t entryDigest, const std::string& convertedText);
+
+private:
+    struct TableRecord
+    {
+        uint64_t	inputDigest = 0;
+        uint64_t	sourceDigest = 0;
+        uint64_t	outputDigest = 0;
+        // Empty if the output is identical to the source
+        std::string	outputBlock;
+    };
+
+    struct ConvertedEntry
+    {
+        uint32_t	lastUsedBuild = 0;
+        std::string	convertedText;
+    };
+
+    static const uint32_t CACHE_FORMAT_VERSION = 2;
+    // Converted entries not used for this many builds are dropped when saving
+    static const uint32_t ENTRY_RETENTION_BUILDS = 16;
+
+    uint64_t ComputeSettingsDigest(GXTEnum::eGXTVersion fileVersion, GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage);
+    uint64_t GetInputDigest(const FixedName8& tableName);
+
+    std::wstring	_cacheFileName;
+    std::wstring	_textSourceDirectory;
+    uint64_t		_settingsDigest;
+    uint32_t		_buildNumber = 0;
+
+    std::map<FixedName8, TableRecord>				_tableRecords;
+    std::unordered_map<FixedName8, uint64_t>		_inputDigests;
+    std::unordered_map<uint64_t, ConvertedEntry>	_convertedEntries;
+};
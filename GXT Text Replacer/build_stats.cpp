@@ -0,0 +1,451 @@
+#include "build_stats.h"
+#include "build_trace.h"
+#include "json.h"
+#include "platform.h"
+
+#include <array>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <iomanip>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    struct TableStats
+    {
+        std::array<std::chrono::steady_clock::duration, BuildStats::PHASE_COUNT>	phaseTimes{};
+        std::array<uint64_t, BuildStats::COUNTER_COUNT>								counters{};
+        // Bytes allocated minus bytes freed, negative if a phase freed what an earlier one allocated
+        std::array<int64_t, BuildStats::PHASE_COUNT>								phaseLiveBytes{};
+    };
+
+    const char* const PHASE_NAMES[BuildStats::PHASE_COUNT] =
+    {
+        "other", "read_gxt", "scan_directory", "validate_utf8", "load_texts", "convert_encoding", "apply_charmap", "replace_entries", "write_gxt"
+    };
+    const char* const PHASE_HEADERS[BuildStats::PHASE_COUNT] =
+    {
+        "Other", "Read", "Scan", "Validate", "Load", "Encode", "Charmap", "Replace", "Write"
+    };
+    const char* const COUNTER_NAMES[BuildStats::COUNTER_COUNT] =
+    {
+        "entries_read", "entries_replaced", "bytes_read", "bytes_written", "files_opened", "allocations", "allocated_bytes"
+    };
+    const char* const COUNTER_HEADERS[BuildStats::COUNTER_COUNT] =
+    {
+        "Entries", "Replaced", "Bytes in", "Bytes out", "Files", "Allocs", "Alloc bytes"
+    };
+
+    // Work that doesn't belong to a table, like the header and TABL
+    const std::string FILE_ROW_NAME = "-";
+
+    std::atomic<bool>		enabled{ false };
+    std::atomic<uint64_t>	allocationCount{ 0 };
+    std::atomic<uint64_t>	allocatedByteCount{ 0 };
+    std::atomic<int64_t>	liveByteCount{ 0 };
+    std::atomic<int64_t>	peakLiveByteCount{ 0 };
+    std::array<std::atomic<int64_t>, BuildStats::PHASE_COUNT>	phasePeakLiveByteCounts{};
+
+    // Rows in the order their tables were first seen
+    std::mutex									statsMutex;
+    std::vector<std::string>					tableOrder;
+    std::map<std::string, TableStats>			tableStats;
+
+    thread_local BuildStats::ScopedTimer*		currentTimer = nullptr;
+    thread_local const std::string*				currentTableName = nullptr;
+
+    // Call with statsMutex locked
+    TableStats& GetCurrentTableStats()
+    {
+        const std::string& tableName = currentTableName != nullptr ? *currentTableName : FILE_ROW_NAME;
+
+        auto itr = tableStats.find(tableName);
+        if (itr == tableStats.end())
+        {
+            tableOrder.push_back(tableName);
+            itr = tableStats.emplace(tableName, TableStats()).first;
+        }
+        return itr->second;
+    }
+
+    void UpdatePeak(std::atomic<int64_t>& peak, int64_t value)
+    {
+        int64_t peakValue = peak.load(std::memory_order_relaxed);
+        while (value > peakValue && !peak.compare_exchange_weak(peakValue, value, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    double ToMilliseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    TableStats ComputeTotal()
+    {
+        TableStats total;
+        for (const auto& pair : tableStats)
+        {
+            for (size_t i = 0; i < BuildStats::PHASE_COUNT; i++)
+            {
+                total.phaseTimes[i] += pair.second.phaseTimes[i];
+            }
+            for (size_t i = 0; i < BuildStats::COUNTER_COUNT; i++)
+            {
+                total.counters[i] += pair.second.counters[i];
+            }
+            for (size_t i = 0; i < BuildStats::PHASE_COUNT; i++)
+            {
+                total.phaseLiveBytes[i] += pair.second.phaseLiveBytes[i];
+            }
+        }
+        return total;
+    }
+}
+
+BuildStats::ScopedTimer::ScopedTimer(ePhase phase)
+    : _phase(phase), _active(IsEnabled()), _traced(BuildTrace::IsEnabled()), _startMemory(), _parent(nullptr)
+{
+    if (_traced)
+    {
+        BuildTrace::Begin(PHASE_NAMES[phase], "phase");
+    }
+    if (!_active)
+    {
+        return;
+    }
+
+    Restart(std::chrono::steady_clock::now());
+
+    _parent = currentTimer;
+    if (_parent != nullptr)
+    {
+        _parent->Flush(_start);
+    }
+    currentTimer = this;
+}
+
+BuildStats::ScopedTimer::~ScopedTimer()
+{
+    if (_traced)
+    {
+        BuildTrace::End();
+    }
+    if (!_active)
+    {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    Flush(now);
+
+    currentTimer = _parent;
+    if (_parent != nullptr)
+    {
+        // The enclosing phase resumes without the time and memory of this one
+        _parent->Restart(now);
+    }
+}
+
+void BuildStats::ScopedTimer::Flush(std::chrono::steady_clock::time_point now)
+{
+    const MemorySnapshot memory = GetMemorySnapshot();
+    AddSample(_phase, now - _start, { memory.allocations - _startMemory.allocations, memory.allocatedBytes - _startMemory.allocatedBytes,
+        memory.liveBytes - _startMemory.liveBytes });
+
+    _start = now;
+    _startMemory = memory;
+}
+
+void BuildStats::ScopedTimer::Restart(std::chrono::steady_clock::time_point now)
+{
+    _start = now;
+    _startMemory = GetMemorySnapshot();
+}
+
+BuildStats::TableScope::TableScope(const std::string& tableName)
+    : _active(IsEnabled()), _traced(BuildTrace::IsEnabled()), _previousTableName(currentTableName), _tableName(tableName)
+{
+    if (_traced)
+    {
+        BuildTrace::Begin(_tableName, "table");
+    }
+    if (!_active)
+    {
+        return;
+    }
+
+    // The running phase is counted for the previous table until now
+    if (currentTimer != nullptr)
+    {
+        currentTimer->Flush(std::chrono::steady_clock::now());
+    }
+    currentTableName = &_tableName;
+}
+
+BuildStats::TableScope::~TableScope()
+{
+    if (_traced)
+    {
+        BuildTrace::End();
+    }
+    if (!_active)
+    {
+        return;
+    }
+
+    if (currentTimer != nullptr)
+    {
+        currentTimer->Flush(std::chrono::steady_clock::now());
+    }
+    currentTableName = _previousTableName;
+}
+
+void BuildStats::Enable()
+{
+    // Allocations are only counted from here on, so the heap bytes are relative to what the process had in use now
+    allocationCount = 0;
+    allocatedByteCount = 0;
+    liveByteCount = 0;
+    peakLiveByteCount = 0;
+    for (auto& phasePeakLiveByteCount : phasePeakLiveByteCounts)
+    {
+        phasePeakLiveByteCount = 0;
+    }
+    enabled = true;
+}
+
+bool BuildStats::IsEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void BuildStats::Add(eCounter counter, uint64_t value)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    GetCurrentTableStats().counters[counter] += value;
+}
+
+void BuildStats::CountAllocation(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedByteCount.fetch_add(size, std::memory_order_relaxed);
+
+    const int64_t liveBytes = liveByteCount.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed) + static_cast<int64_t>(size);
+    UpdatePeak(peakLiveByteCount, liveBytes);
+    UpdatePeak(phasePeakLiveByteCounts[currentTimer != nullptr ? currentTimer->_phase : PhaseOther], liveBytes);
+}
+
+void BuildStats::CountFree(size_t size)
+{
+    liveByteCount.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+int64_t BuildStats::GetPeakHeapBytes()
+{
+    return peakLiveByteCount.load(std::memory_order_relaxed);
+}
+
+int64_t BuildStats::GetPeakHeapBytes(ePhase phase)
+{
+    return phasePeakLiveByteCounts[phase].load(std::memory_order_relaxed);
+}
+
+BuildStats::MemorySnapshot BuildStats::GetMemorySnapshot()
+{
+    return { allocationCount.load(std::memory_order_relaxed), allocatedByteCount.load(std::memory_order_relaxed), liveByteCount.load(std::memory_order_relaxed) };
+}
+
+void BuildStats::AddSample(ePhase phase, std::chrono::steady_clock::duration duration, const MemorySnapshot& memory)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    TableStats& stats = GetCurrentTableStats();
+    stats.phaseTimes[phase] += duration;
+    stats.counters[CounterAllocations] += memory.allocations;
+    stats.counters[CounterAllocatedBytes] += memory.allocatedBytes;
+    stats.phaseLiveBytes[phase] += memory.liveBytes;
+}
+
+void BuildStats::PrintReport(std::ostream& stream)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    auto printRow = [&](const std::string& name, const TableStats& stats)
+    {
+        stream << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(2);
+
+        std::chrono::steady_clock::duration totalTime{};
+        for (size_t i = 0; i < PHASE_COUNT; i++)
+        {
+            stream << std::setw(10) << ToMilliseconds(stats.phaseTimes[i]);
+            totalTime += stats.phaseTimes[i];
+        }
+        stream << std::setw(10) << ToMilliseconds(totalTime);
+
+        for (size_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            stream << std::setw(12) << stats.counters[i];
+        }
+        stream << "\n";
+    };
+    auto printMemoryRow = [&](const std::string& name, const TableStats& stats)
+    {
+        stream << std::left << std::setw(10) << name << std::right;
+
+        int64_t totalLiveBytes = 0;
+        for (size_t i = 0; i < PHASE_COUNT; i++)
+        {
+            stream << std::setw(12) << stats.phaseLiveBytes[i];
+            totalLiveBytes += stats.phaseLiveBytes[i];
+        }
+        stream << std::setw(12) << totalLiveBytes << "\n";
+    };
+
+    stream << "Milliseconds per phase and counters per table:\n";
+    stream << std::left << std::setw(10) << "Table" << std::right;
+    for (size_t i = 0; i < PHASE_COUNT; i++)
+    {
+        stream << std::setw(10) << PHASE_HEADERS[i];
+    }
+    stream << std::setw(10) << "Total";
+    for (size_t i = 0; i < COUNTER_COUNT; i++)
+    {
+        stream << std::setw(12) << COUNTER_HEADERS[i];
+    }
+    stream << "\n";
+
+    const TableStats total = ComputeTotal();
+    for (const auto& tableName : tableOrder)
+    {
+        printRow(tableName, tableStats[tableName]);
+    }
+    printRow("Total", total);
+    stream << std::defaultfloat;
+
+    stream << "\nHeap bytes left allocated per phase and table:\n";
+    stream << std::left << std::setw(10) << "Table" << std::right;
+    for (size_t i = 0; i < PHASE_COUNT; i++)
+    {
+        stream << std::setw(12) << PHASE_HEADERS[i];
+    }
+    stream << std::setw(12) << "Total" << "\n";
+
+    for (const auto& tableName : tableOrder)
+    {
+        printMemoryRow(tableName, tableStats[tableName]);
+    }
+    printMemoryRow("Total", total);
+
+    stream << std::left << std::setw(10) << "Peak" << std::right;
+    for (size_t i = 0; i < PHASE_COUNT; i++)
+    {
+        stream << std::setw(12) << GetPeakHeapBytes(static_cast<ePhase>(i));
+    }
+    stream << "\n";
+
+    stream << "\nPeak heap bytes: " << GetPeakHeapBytes() << "\n";
+    stream << "Peak resident bytes: " << Platform::GetPeakResidentBytes() << "\n";
+}
+
+void BuildStats::WriteJson(std::ostream& stream)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    auto writeStats = [&](const TableStats& stats)
+    {
+        stream << "\"milliseconds\":{";
+        for (size_t i = 0; i < PHASE_COUNT; i++)
+        {
+            stream << (i > 0 ? "," : "") << "\"" << PHASE_NAMES[i] << "\":" << ToMilliseconds(stats.phaseTimes[i]);
+        }
+        stream << "},\"live_bytes\":{";
+        for (size_t i = 0; i < PHASE_COUNT; i++)
+        {
+            stream << (i > 0 ? "," : "") << "\"" << PHASE_NAMES[i] << "\":" << stats.phaseLiveBytes[i];
+        }
+        stream << "}";
+        for (size_t i = 0; i < COUNTER_COUNT; i++)
+        {
+            stream << ",\"" << COUNTER_NAMES[i] << "\":" << stats.counters[i];
+        }
+    };
+
+    stream << "{\"tables\":[";
+    for (size_t i = 0; i < tableOrder.size(); i++)
+    {
+        stream << (i > 0 ? "," : "") << "{\"name\":" << Json::Escape(tableOrder[i]) << ",";
+        writeStats(tableStats[tableOrder[i]]);
+        stream << "}";
+    }
+    stream << "],\"total\":{";
+    writeStats(ComputeTotal());
+    stream << "},\"phase_peak_heap_bytes\":{";
+    for (size_t i = 0; i < PHASE_COUNT; i++)
+    {
+        stream << (i > 0 ? "," : "") << "\"" << PHASE_NAMES[i] << "\":" << GetPeakHeapBytes(static_cast<ePhase>(i));
+    }
+    stream << "},\"peak_heap_bytes\":" << GetPeakHeapBytes()
+        << ",\"peak_resident_bytes\":" << Platform::GetPeakResidentBytes() << "}\n";
+}
+
+#ifdef GXT_ENABLE_STATS
+// Once the stats are enabled, every allocation of the process is counted with a few relaxed atomic operations. The usable
+// size of the block is counted rather than the requested one, because the unsized delete has nothing else to subtract.
+// Without -stats only the enabled flag is read.
+// GCC sees operator delete free what operator new returned and warns, although this operator new got it from malloc.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size)
+{
+    if (size == 0)
+    {
+        size = 1;
+    }
+    for (;;)
+    {
+        void* memory = std::malloc(size);
+        if (memory != nullptr)
+        {
+            if (BuildStats::IsEnabled())
+            {
+                BuildStats::CountAllocation(Platform::GetAllocationSize(memory));
+            }
+            return memory;
+        }
+
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* memory) noexcept
+{
+    if (memory != nullptr)
+    {
+        if (BuildStats::IsEnabled())
+        {
+            BuildStats::CountFree(Platform::GetAllocationSize(memory));
+        }
+        std::free(memory);
+    }
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    operator delete(memory);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
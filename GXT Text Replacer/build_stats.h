@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+// Wall time and counters of the phases of a build, reported with -stats. ScopedTimer measures a phase with a monotonic
+// clock and TableScope attributes it to a table. A nested timer pauses the enclosing one, so every moment of a build is
+// counted in exactly one phase. Allocations are counted by the replaced global operator new and delete, which also
+// track the heap bytes in use, so every phase of a table reports the bytes it allocated and the bytes it left allocated.
+// With -trace both scopes also record begin and end events in the BuildTrace.
+// Without GXT_ENABLE_STATS the GXT_STATS_* macros expand to nothing and operator new isn't replaced.
+class BuildStats
+{
+public:
+    enum ePhase
+    {
+        // Everything outside the other phases: the build cache, the index, option parsing
+        PhaseOther,
+        PhaseReadGXT,
+        PhaseScanDirectory,
+        PhaseValidateUtf8,
+        PhaseLoadTexts,
+        PhaseConvertEncoding,
+        PhaseApplyCharacterMap,
+        PhaseReplaceEntries,
+        PhaseWriteGXT,
+        PHASE_COUNT
+    };
+
+    enum eCounter
+    {
+        CounterEntriesRead,
+        CounterEntriesReplaced,
+        CounterBytesRead,
+        CounterBytesWritten,
+        CounterFilesOpened,
+        CounterAllocations,
+        CounterAllocatedBytes,
+        COUNTER_COUNT
+    };
+
+private:
+    struct MemorySnapshot
+    {
+        uint64_t	allocations;
+        uint64_t	allocatedBytes;
+        int64_t		liveBytes;
+    };
+
+public:
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(ePhase phase);
+        ~ScopedTimer();
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        friend class BuildStats;
+
+        // Records the time and memory since the last flush
+        void Flush(std::chrono::steady_clock::time_point now);
+        void Restart(std::chrono::steady_clock::time_point now);
+
+        ePhase									_phase;
+        bool									_active;
+        bool									_traced;
+        std::chrono::steady_clock::time_point	_start;
+        MemorySnapshot							_startMemory;
+        ScopedTimer*							_parent;
+    };
+
+    class TableScope
+    {
+    public:
+        explicit TableScope(const std::string& tableName);
+        ~TableScope();
+
+        TableScope(const TableScope&) = delete;
+        TableScope& operator=(const TableScope&) = delete;
+
+    private:
+        bool				_active;
+        bool				_traced;
+        const std::string*	_previousTableName;
+        std::string			_tableName;
+    };
+
+    static void Enable();
+    static bool IsEnabled();
+
+    // Adds to the counter of the current table
+    static void Add(eCounter counter, uint64_t value);
+    // Called by operator new and delete with the usable size of the block once the stats are enabled
+    static void CountAllocation(size_t size);
+    static void CountFree(size_t size);
+
+    // The most heap bytes the process had in use, overall or while the phase was running on the allocating thread
+    static int64_t GetPeakHeapBytes();
+    static int64_t GetPeakHeapBytes(ePhase phase);
+
+    // One row per table with the milliseconds of every phase and the counters, the same with the heap bytes every phase
+    // left allocated, rows with the totals, the peak heap bytes of every phase, and the peak heap bytes and resident set
+    // of the process
+    static void PrintReport(std::ostream& stream);
+    static void WriteJson(std::ostream& stream);
+
+private:
+    static MemorySnapshot GetMemorySnapshot();
+    static void AddSample(ePhase phase, std::chrono::steady_clock::duration duration, const MemorySnapshot& memory);
+};
+
+#ifdef GXT_ENABLE_STATS
+#define GXT_STATS_CONCAT_IMPL(a, b) a##b
+#define GXT_STATS_CONCAT(a, b) GXT_STATS_CONCAT_IMPL(a, b)
+#define GXT_STATS_TIMER(phase) BuildStats::ScopedTimer GXT_STATS_CONCAT(statsTimer, __LINE__)(BuildStats::phase)
+#define GXT_STATS_TABLE(tableName) BuildStats::TableScope GXT_STATS_CONCAT(statsTable, __LINE__)(tableName)
+#define GXT_STATS_ADD(counter, value) do { if (BuildStats::IsEnabled()) BuildStats::Add(BuildStats::counter, (value)); } while( false )
+#else
+#define GXT_STATS_TIMER(phase) do { } while ( false )
+#define GXT_STATS_TABLE(tableName) do { } while ( false )
+#define GXT_STATS_ADD(counter, value) do { } while ( false )
+#endif
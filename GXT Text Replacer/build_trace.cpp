@@ -0,0 +1,151 @@
+#include "build_trace.h"
+#include "json.h"
+
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+    struct TraceEvent
+    {
+        std::chrono::steady_clock::time_point	time;
+        // 'B' or 'E'
+        char									phase;
+        const char*								name;
+        // Used instead of name if name is nullptr
+        std::string								dynamicName;
+        const char*								category;
+    };
+
+    // Only the owning thread appends to its buffer, Write reads them after the threads finished
+    struct ThreadBuffer
+    {
+        size_t					threadIndex = 0;
+        std::vector<TraceEvent>	events;
+    };
+
+    std::atomic<bool>							enabled{ false };
+    std::chrono::steady_clock::time_point		traceStart;
+
+    // Buffers are registered once per thread, so recording an event never locks. They outlive their threads.
+    std::mutex									registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>>	threadBuffers;
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        thread_local ThreadBuffer* threadBuffer = nullptr;
+        if (threadBuffer == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            threadBuffers.push_back(std::make_unique<ThreadBuffer>());
+            threadBuffer = threadBuffers.back().get();
+            threadBuffer->threadIndex = threadBuffers.size();
+            threadBuffer->events.reserve(1024);
+        }
+        return *threadBuffer;
+    }
+}
+
+BuildTrace::Scope::Scope(const char* name, const char* category)
+    : _active(IsEnabled())
+{
+    if (_active)
+    {
+        Begin(name, category);
+    }
+}
+
+BuildTrace::Scope::Scope(const std::string& name, const char* category)
+    : _active(IsEnabled())
+{
+    if (_active)
+    {
+        Begin(name, category);
+    }
+}
+
+BuildTrace::Scope::~Scope()
+{
+    if (_active)
+    {
+        End();
+    }
+}
+
+void BuildTrace::Enable()
+{
+    traceStart = std::chrono::steady_clock::now();
+    // The thread enabling the trace is listed first as the main thread
+    GetThreadBuffer();
+    enabled = true;
+}
+
+bool BuildTrace::IsEnabled()
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void BuildTrace::Begin(const char* name, const char* category)
+{
+    GetThreadBuffer().events.push_back(TraceEvent{ std::chrono::steady_clock::now(), 'B', name, std::string(), category });
+}
+
+void BuildTrace::Begin(const std::string& name, const char* category)
+{
+    GetThreadBuffer().events.push_back(TraceEvent{ std::chrono::steady_clock::now(), 'B', nullptr, name, category });
+}
+
+void BuildTrace::End()
+{
+    GetThreadBuffer().events.push_back(TraceEvent{ std::chrono::steady_clock::now(), 'E', nullptr, std::string(), nullptr });
+}
+
+void BuildTrace::Write(std::ostream& stream)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // Merged into one timeline, the events of a thread keep their order
+    std::vector<std::pair<size_t, const TraceEvent*>> events;
+    for (const auto& threadBuffer : threadBuffers)
+    {
+        for (const auto& event : threadBuffer->events)
+        {
+            events.emplace_back(threadBuffer->threadIndex, &event);
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.second->time < rhs.second->time;
+    });
+
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    for (const auto& threadBuffer : threadBuffers)
+    {
+        const std::string threadName = threadBuffer->threadIndex == 1 ? "main" : "worker " + std::to_string(threadBuffer->threadIndex - 1);
+        stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadBuffer->threadIndex
+            << ",\"args\":{\"name\":" << Json::Escape(threadName) << "}}";
+        first = false;
+    }
+
+    stream << std::fixed << std::setprecision(3);
+    for (const auto& pair : events)
+    {
+        const TraceEvent& event = *pair.second;
+        const double timestamp = std::chrono::duration<double, std::micro>(event.time - traceStart).count();
+
+        stream << ",\n{\"ph\":\"" << event.phase << "\",\"pid\":1,\"tid\":" << pair.first << ",\"ts\":" << timestamp;
+        if (event.phase == 'B')
+        {
+            stream << ",\"name\":" << Json::Escape(event.name != nullptr ? std::string(event.name) : event.dynamicName) << ",\"cat\":\"" << event.category << "\"";
+        }
+        stream << "}";
+    }
+    stream << "\n]}\n" << std::defaultfloat;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <ostream>
+
+// Begin and end events of the build phases, tables and worker chunks in the Chrome trace-event format, recorded with -trace
+// and viewable in chrome://tracing or Perfetto. Every thread records into its own buffer without locking, the buffers are
+// only merged by Write, which must run after the worker threads finished.
+// The BuildStats timers and table scopes record their events too. Without GXT_ENABLE_STATS GXT_TRACE_SCOPE expands to nothing.
+class BuildTrace
+{
+public:
+    class Scope
+    {
+    public:
+        // name must outlive the trace, like a string literal
+        Scope(const char* name, const char* category);
+        // For names built at run time, like table names
+        Scope(const std::string& name, const char* category);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool	_active;
+    };
+
+    static void Enable();
+    static bool IsEnabled();
+
+    static void Begin(const char* name, const char* category);
+    static void Begin(const std::string& name, const char* category);
+    static void End();
+
+    // Writes the events of every thread as a JSON trace
+    static void Write(std::ostream& stream);
+};
+
+#ifdef GXT_ENABLE_STATS
+#define GXT_TRACE_CONCAT_IMPL(a, b) a##b
+#define GXT_TRACE_CONCAT(a, b) GXT_TRACE_CONCAT_IMPL(a, b)
+#define GXT_TRACE_SCOPE(name, category) BuildTrace::Scope GXT_TRACE_CONCAT(traceScope, __LINE__)(name, category)
+#else
+#define GXT_TRACE_SCOPE(name, category) do { } while ( false )
+#endif
@@ -1,6 +1,7 @@
 #include "crc32keygen.h"
 
 #include <array>
+#include <cctype>
 
 
 // Precalculated table of 256 CRC32 hash keys computed according to the polynomial 0xEDB88320.
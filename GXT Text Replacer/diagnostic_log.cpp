@@ -0,0 +1,235 @@
+#include "diagnostic_log.h"
+#include "platform.h"
+#include "json.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+namespace
+{
+    const char* const SEVERITY_NAMES[DiagnosticLog::SEVERITY_COUNT] = { "warning", "error" };
+    const char* const SEVERITY_HEADERS[DiagnosticLog::SEVERITY_COUNT] = { "WARNING", "ERROR" };
+
+    std::atomic<uint64_t>	nextLogId{ 1 };
+
+    std::string ToUtf8(const std::wstring& text)
+    {
+        return Platform::FromWide(text, Platform::CODE_PAGE_UTF8);
+    }
+
+    std::string GetTableName(const std::wstring& fileName)
+    {
+        return ToUtf8(Platform::FromPath(Platform::ToPath(fileName).parent_path().filename()));
+    }
+
+    std::string FormatHash(uint32_t hash)
+    {
+        std::ostringstream stream;
+        stream << "0x" << std::hex << std::uppercase << std::setw(8) << std::setfill('0') << hash;
+        return stream.str();
+    }
+}
+
+DiagnosticLog::DiagnosticLog()
+    : _logId(nextLogId++), _format(FormatText), _minimumSeverity(SeverityWarning), _sequence(0)
+{
+}
+
+DiagnosticLog::~DiagnosticLog()
+{
+    Flush();
+}
+
+void DiagnosticLog::Open(const std::wstring& fileName, eFormat format, eSeverity minimumSeverity)
+{
+    Flush();
+
+    std::lock_guard<std::mutex> lock(_queuesMutex);
+    _file.close();
+    _file.open(Platform::ToPath(fileName), std::ofstream::binary);
+    _format = format;
+    _minimumSeverity = minimumSeverity;
+}
+
+DiagnosticLog::ThreadQueue& DiagnosticLog::GetThreadQueue()
+{
+    // Logs are told apart by id rather than address, a new log may reuse the address of a destroyed one
+    thread_local uint64_t		cachedLogId = 0;
+    thread_local ThreadQueue*	cachedQueue = nullptr;
+
+    if (cachedLogId != _logId)
+    {
+        std::lock_guard<std::mutex> lock(_queuesMutex);
+        _queues.push_back(std::make_unique<ThreadQueue>());
+        cachedQueue = _queues.back().get();
+        cachedLogId = _logId;
+    }
+    return *cachedQueue;
+}
+
+void DiagnosticLog::Report(eSeverity severity, const std::wstring& fileName, uint64_t line, const std::string& entryName, std::optional<uint32_t> hash, std::string message)
+{
+    ThreadQueue& queue = GetThreadQueue();
+    size_t queuedCount;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.records.push_back(Record{ _sequence.fetch_add(1, std::memory_order_relaxed), severity, fileName, line, entryName, hash, std::move(message) });
+        queuedCount = queue.records.size();
+    }
+
+    if (queuedCount >= FLUSH_RECORD_COUNT)
+    {
+        Flush();
+    }
+}
+
+void DiagnosticLog::Flush()
+{
+    std::lock_guard<std::mutex> lock(_queuesMutex);
+
+    std::vector<Record> records;
+    for (auto& queue : _queues)
+    {
+        std::lock_guard<std::mutex> queueLock(queue->mutex);
+        std::move(queue->records.begin(), queue->records.end(), std::back_inserter(records));
+        queue->records.clear();
+    }
+    if (records.empty())
+    {
+        return;
+    }
+
+    std::sort(records.begin(), records.end(), [](const Record& lhs, const Record& rhs)
+    {
+        return lhs.sequence < rhs.sequence;
+    });
+
+    std::string output;
+    for (const auto& record : records)
+    {
+        const std::string tableName = GetTableName(record.fileName);
+        _tableCounts[tableName][record.severity]++;
+
+        if (_file.is_open() && record.severity >= _minimumSeverity)
+        {
+            WriteRecord(output, record, tableName);
+        }
+    }
+
+    if (!output.empty())
+    {
+        _file.write(output.data(), output.size());
+        _file.flush();
+    }
+}
+
+void DiagnosticLog::WriteRecord(std::string& output, const Record& record, const std::string& tableName) const
+{
+    if (_format == FormatJsonLines)
+    {
+        output += "{\"severity\":\"";
+        output += SEVERITY_NAMES[record.severity];
+        output += "\",\"table\":" + Json::Escape(tableName);
+        output += ",\"file\":" + Json::Escape(ToUtf8(record.fileName));
+        if (record.line != 0)
+        {
+            output += ",\"line\":" + std::to_string(record.line);
+        }
+        if (!record.entryName.empty())
+        {
+            output += ",\"entry\":" + Json::Escape(record.entryName);
+        }
+        if (record.hash)
+        {
+            output += ",\"hash\":\"" + FormatHash(record.hash.value()) + "\"";
+        }
+        output += ",\"message\":" + Json::Escape(record.message) + "}\n";
+        return;
+    }
+
+    // ERROR: texts/MAIN/a.txt:12: [MAIN] TOOLONGNAME: message
+    output += SEVERITY_HEADERS[record.severity];
+    output += ": " + ToUtf8(record.fileName);
+    if (record.line != 0)
+    {
+        output += ":" + std::to_string(record.line);
+    }
+    output += ": [" + tableName + "]";
+    if (!record.entryName.empty())
+    {
+        output += " " + record.entryName;
+    }
+    if (record.hash)
+    {
+        output += " (" + FormatHash(record.hash.value()) + ")";
+    }
+    output += ": " + record.message + "\n";
+}
+
+void DiagnosticLog::PrintSummary(std::ostream& stream)
+{
+    Flush();
+
+    std::lock_guard<std::mutex> lock(_queuesMutex);
+    if (_tableCounts.empty())
+    {
+        return;
+    }
+
+    auto printCounts = [&](const std::array<uint64_t, SEVERITY_COUNT>& counts)
+    {
+        stream << counts[SeverityError] << " errors, " << counts[SeverityWarning] << " warnings";
+    };
+
+    std::array<uint64_t, SEVERITY_COUNT> totalCounts{};
+    for (const auto& pair : _tableCounts)
+    {
+        for (size_t i = 0; i < SEVERITY_COUNT; i++)
+        {
+            totalCounts[i] += pair.second[i];
+        }
+    }
+
+    stream << "Diagnostics: ";
+    printCounts(totalCounts);
+    stream << "\n";
+    for (const auto& pair : _tableCounts)
+    {
+        stream << "\t" << pair.first << ": ";
+        printCounts(pair.second);
+        stream << "\n";
+    }
+}
+
+uint64_t DiagnosticLog::GetRecordCount(const std::string& tableName)
+{
+    Flush();
+
+    std::lock_guard<std::mutex> lock(_queuesMutex);
+    auto itr = _tableCounts.find(tableName);
+    if (itr == _tableCounts.end())
+    {
+        return 0;
+    }
+
+    uint64_t recordCount = 0;
+    for (const uint64_t count : itr->second)
+    {
+        recordCount += count;
+    }
+    return recordCount;
+}
+
+std::optional<DiagnosticLog::eSeverity> DiagnosticLog::ParseSeverity(const std::string& name)
+{
+    for (size_t i = 0; i < SEVERITY_COUNT; i++)
+    {
+        if (name == SEVERITY_NAMES[i])
+        {
+            return static_cast<eSeverity>(i);
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <optional>
+#include <cstdint>
+
+// The problems found in the text files, like invalid or duplicated entry names. Every thread queues its records without
+// taking a shared lock, and Flush writes the queued records of all threads to the log file in the order they were
+// reported, as text lines or JSON lines. Flushed records are counted per severity and table even if the log file isn't open.
+class DiagnosticLog
+{
+public:
+    enum eSeverity
+    {
+        SeverityWarning,
+        SeverityError,
+        SEVERITY_COUNT
+    };
+
+    enum eFormat
+    {
+        FormatText,
+        FormatJsonLines
+    };
+
+    DiagnosticLog();
+    // Flushes the queued records
+    ~DiagnosticLog();
+
+    DiagnosticLog(const DiagnosticLog&) = delete;
+    DiagnosticLog& operator=(const DiagnosticLog&) = delete;
+
+    // Records below minimumSeverity are counted but not written
+    void Open(const std::wstring& fileName, eFormat format = FormatText, eSeverity minimumSeverity = SeverityWarning);
+
+    // The table is the name of the folder of the text file. line is 0 and hash is empty if they aren't known.
+    void Report(eSeverity severity, const std::wstring& fileName, uint64_t line, const std::string& entryName, std::optional<uint32_t> hash, std::string message);
+    void Flush();
+
+    // The number of records per severity, in total and per table. Prints nothing if nothing was reported.
+    void PrintSummary(std::ostream& stream);
+    // The number of records of every severity reported for the table so far
+    uint64_t GetRecordCount(const std::string& tableName);
+
+    static std::optional<eSeverity> ParseSeverity(const std::string& name);
+
+private:
+    struct Record
+    {
+        uint64_t				sequence;
+        eSeverity				severity;
+        std::wstring			fileName;
+        uint64_t				line;
+        std::string				entryName;
+        std::optional<uint32_t>	hash;
+        std::string				message;
+    };
+
+    // The mutex is only contended while Flush takes the records
+    struct ThreadQueue
+    {
+        std::mutex			mutex;
+        std::vector<Record>	records;
+    };
+
+    static constexpr size_t	FLUSH_RECORD_COUNT = 1024;
+
+    ThreadQueue& GetThreadQueue();
+    void WriteRecord(std::string& output, const Record& record, const std::string& tableName) const;
+
+    const uint64_t											_logId;
+    std::ofstream											_file;
+    eFormat													_format;
+    eSeverity												_minimumSeverity;
+
+    std::atomic<uint64_t>									_sequence;
+
+    // Guards the queue list and the table counts
+    std::mutex												_queuesMutex;
+    std::vector<std::unique_ptr<ThreadQueue>>				_queues;
+    std::map<std::string, std::array<uint64_t, SEVERITY_COUNT>>	_tableCounts;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// Reports changes to the files in a directory tree (directory_watcher_win32.cpp with ReadDirectoryChangesW and
+// directory_watcher_posix.cpp with inotify)
+class DirectoryWatcher
+{
+public:
+    // Returned instead of file names when the change buffer overflowed and everything has to be rescanned
+    static constexpr wchar_t RESCAN_ALL[] = L"*";
+
+    explicit DirectoryWatcher(const std::wstring& directory);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    // Waits up to timeoutMilliseconds and returns the changed paths relative to the watched directory
+    // (an empty list means the wait timed out)
+    std::vector<std::wstring> WaitForChanges(uint32_t timeoutMilliseconds);
+
+private:
+#ifdef _WIN32
+    void IssueRead();
+
+    void*				_directoryHandle = nullptr;
+    void*				_eventHandle = nullptr;
+    void*				_overlapped = nullptr;
+    std::vector<unsigned long>	_buffer;
+#else
+    // inotify only watches single directories, so every subdirectory gets its own watch
+    void AddWatch(const std::wstring& relativeDirectory);
+
+    std::wstring		_directory;
+    int					_inotifyDescriptor = -1;
+    // Directories relative to _directory by watch descriptor
+    std::map<int, std::wstring>	_watchedDirectories;
+    std::vector<char>	_buffer;
+#endif
+};
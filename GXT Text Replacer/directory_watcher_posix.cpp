@@ -0,0 +1,127 @@
+#include "directory_watcher.h"
+#include "platform.h"
+
+#include <stdexcept>
+#include <climits>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+constexpr wchar_t DirectoryWatcher::RESCAN_ALL[];
+
+DirectoryWatcher::DirectoryWatcher(const std::wstring& directory)
+    : _directory(directory)
+{
+    _inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (_inotifyDescriptor == -1)
+    {
+        throw std::runtime_error("Can't watch " + std::string(directory.begin(), directory.end()) + "!");
+    }
+
+    // Large enough for a burst of events, every event fits because names are at most NAME_MAX bytes
+    _buffer.resize(64 * 1024);
+
+    try
+    {
+        AddWatch(std::wstring());
+    }
+    catch (...)
+    {
+        close(_inotifyDescriptor);
+        throw;
+    }
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    // Closing the descriptor removes every watch
+    close(_inotifyDescriptor);
+}
+
+void DirectoryWatcher::AddWatch(const std::wstring& relativeDirectory)
+{
+    const std::wstring directory = relativeDirectory.empty() ? _directory : _directory + Platform::PATH_SEPARATOR + relativeDirectory;
+    const uint32_t eventMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+    const int watchDescriptor = inotify_add_watch(_inotifyDescriptor, Platform::ToPath(directory).c_str(), eventMask);
+    if (watchDescriptor == -1)
+    {
+        // Subdirectories may be gone again before they're watched
+        if (relativeDirectory.empty())
+        {
+            throw std::runtime_error("Can't watch " + std::string(directory.begin(), directory.end()) + "!");
+        }
+        return;
+    }
+    _watchedDirectories[watchDescriptor] = relativeDirectory;
+
+    std::error_code errorCode;
+    for (const auto& p : std::filesystem::directory_iterator(Platform::ToPath(directory), errorCode))
+    {
+        if (p.is_directory(errorCode))
+        {
+            const std::wstring name = Platform::FromPath(p.path().filename());
+            AddWatch(relativeDirectory.empty() ? name : relativeDirectory + Platform::PATH_SEPARATOR + name);
+        }
+    }
+}
+
+std::vector<std::wstring> DirectoryWatcher::WaitForChanges(uint32_t timeoutMilliseconds)
+{
+    std::vector<std::wstring> changedPaths;
+
+    pollfd pollDescriptor = { _inotifyDescriptor, POLLIN, 0 };
+    const int timeout = timeoutMilliseconds > static_cast<uint32_t>(INT_MAX) ? -1 : static_cast<int>(timeoutMilliseconds);
+    if (poll(&pollDescriptor, 1, timeout) <= 0)
+    {
+        return changedPaths;
+    }
+
+    for (;;)
+    {
+        const ssize_t bytesRead = read(_inotifyDescriptor, _buffer.data(), _buffer.size());
+        if (bytesRead <= 0)
+        {
+            break;
+        }
+
+        for (const char* record = _buffer.data(); record < _buffer.data() + bytesRead;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(record);
+            record += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                changedPaths.emplace_back(RESCAN_ALL);
+                continue;
+            }
+
+            auto itr = _watchedDirectories.find(event->wd);
+            if (itr == _watchedDirectories.end())
+            {
+                continue;
+            }
+            if (event->mask & IN_IGNORED)
+            {
+                _watchedDirectories.erase(itr);
+                continue;
+            }
+
+            const std::wstring name = event->len > 0 ? Platform::FromPath(std::filesystem::path(event->name)) : std::wstring();
+            const std::wstring relativePath = itr->second.empty() ? name : itr->second + Platform::PATH_SEPARATOR + name;
+
+            // Files may have been created in a new directory before it was watched
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+            {
+                AddWatch(relativePath);
+                changedPaths.emplace_back(RESCAN_ALL);
+                continue;
+            }
+
+            changedPaths.push_back(relativePath);
+        }
+    }
+
+    return changedPaths;
+}
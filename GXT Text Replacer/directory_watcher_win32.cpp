@@ -0,0 +1,89 @@
+#include "directory_watcher.h"
+
+#include <stdexcept>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+constexpr wchar_t DirectoryWatcher::RESCAN_ALL[];
+
+DirectoryWatcher::DirectoryWatcher(const std::wstring& directory)
+{
+    HANDLE directoryHandle = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+    if (directoryHandle == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Can't watch " + std::string(directory.begin(), directory.end()) + "!");
+    }
+    _directoryHandle = directoryHandle;
+
+    _eventHandle = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (_eventHandle == nullptr)
+    {
+        CloseHandle(directoryHandle);
+        throw std::runtime_error("Can't watch " + std::string(directory.begin(), directory.end()) + "!");
+    }
+
+    OVERLAPPED* overlapped = new OVERLAPPED();
+    overlapped->hEvent = _eventHandle;
+    _overlapped = overlapped;
+
+    // ReadDirectoryChangesW needs a DWORD-aligned buffer
+    _buffer.resize(64 * 1024 / sizeof(unsigned long));
+
+    IssueRead();
+}
+
+DirectoryWatcher::~DirectoryWatcher()
+{
+    CancelIo(_directoryHandle);
+    CloseHandle(_directoryHandle);
+    CloseHandle(_eventHandle);
+    delete static_cast<OVERLAPPED*>(_overlapped);
+}
+
+void DirectoryWatcher::IssueRead()
+{
+    const DWORD notifyFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE;
+    if (!ReadDirectoryChangesW(_directoryHandle, _buffer.data(), static_cast<DWORD>(_buffer.size() * sizeof(unsigned long)), TRUE,
+        notifyFilter, nullptr, static_cast<OVERLAPPED*>(_overlapped), nullptr))
+    {
+        throw std::runtime_error("Can't read directory changes!");
+    }
+}
+
+std::vector<std::wstring> DirectoryWatcher::WaitForChanges(uint32_t timeoutMilliseconds)
+{
+    std::vector<std::wstring> changedPaths;
+
+    if (WaitForSingleObject(_eventHandle, timeoutMilliseconds) != WAIT_OBJECT_0)
+    {
+        return changedPaths;
+    }
+
+    DWORD bytesTransferred = 0;
+    GetOverlappedResult(_directoryHandle, static_cast<OVERLAPPED*>(_overlapped), &bytesTransferred, FALSE);
+
+    if (bytesTransferred == 0)
+    {
+        changedPaths.emplace_back(RESCAN_ALL);
+    }
+    else
+    {
+        const char* record = reinterpret_cast<const char*>(_buffer.data());
+        for (;;)
+        {
+            const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(record);
+            changedPaths.emplace_back(info->FileName, info->FileNameLength / sizeof(wchar_t));
+
+            if (info->NextEntryOffset == 0)
+                break;
+            record += info->NextEntryOffset;
+        }
+    }
+
+    // Starting the next read resets the event
+    IssueRead();
+
+    return changedPaths;
+}
@@ -6,7 +6,9 @@ namespace GXTEnum
     {
         GXT_VC,
         GXT_SA,
-        GXT_SA_MOBILE
+        GXT_SA_MOBILE,
+        // SA GXT files with the 0x100004 header, whose texts are 16-bit
+        GXT_SA_16BIT
     };
 
     enum eTextConvertingMode
@@ -15,4 +17,15 @@ namespace GXTEnum
         UseUtf8OrUtf16,
         UseAnsi
     };
+
+    // How GXTTable::ReplaceEntries matches the replaced entries against TKEY
+    enum eReplaceStrategy
+    {
+        // Picked per table from its number of entries
+        ReplaceAuto,
+        // Looks up every TKEY entry in the entry map
+        ReplaceHashProbe,
+        // Radix sorts the entry map by key and merges it with the key-sorted TKEY
+        ReplaceSortMerge
+    };
 }
\ No newline at end of file
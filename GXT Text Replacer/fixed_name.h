@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <functional>
+#include <cstdint>
+
+// Table or entry name of at most 8 bytes, as stored NUL-padded in TABL, mission table headers and VC TKEY entries.
+// The bytes are packed big-endian into an integer, so comparing two names orders them like comparing their padded bytes.
+class FixedName8
+{
+public:
+    static constexpr size_t SIZE = 8;
+
+    FixedName8()
+    {}
+
+    // Longer names are truncated
+    explicit FixedName8(std::string_view name)
+    {
+        for (size_t i = 0; i < SIZE; i++)
+        {
+            _value = (_value << 8) | (i < name.size() ? static_cast<unsigned char>(name[i]) : 0);
+        }
+    }
+
+    // Reads SIZE raw bytes
+    static FixedName8 Read(const char* data)
+    {
+        return FixedName8(std::string_view(data, SIZE));
+    }
+
+    // Writes SIZE NUL-padded bytes
+    void Write(char* data) const
+    {
+        for (size_t i = 0; i < SIZE; i++)
+        {
+            data[i] = static_cast<char>(_value >> ((SIZE - 1 - i) * 8));
+        }
+    }
+
+    std::array<char, SIZE> ToBytes() const
+    {
+        std::array<char, SIZE> bytes;
+        Write(bytes.data());
+        return bytes;
+    }
+
+    // The name without the padding
+    std::string ToString() const
+    {
+        const auto bytes = ToBytes();
+
+        size_t length = 0;
+        while (length < SIZE && bytes[length] != '\0')
+        {
+            length++;
+        }
+        return std::string(bytes.data(), length);
+    }
+
+    uint64_t GetValue() const
+    {
+        return _value;
+    }
+
+    bool operator==(const FixedName8& rhs) const
+    {
+        return _value == rhs._value;
+    }
+    bool operator!=(const FixedName8& rhs) const
+    {
+        return _value != rhs._value;
+    }
+    bool operator<(const FixedName8& rhs) const
+    {
+        return _value < rhs._value;
+    }
+
+private:
+    uint64_t	_value = 0;
+};
+
+namespace std
+{
+    template<>
+    struct hash<FixedName8>
+    {
+        size_t operator()(const FixedName8& name) const
+        {
+            return std::hash<uint64_t>()(name.GetValue());
+        }
+    };
+}
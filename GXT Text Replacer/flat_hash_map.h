@@ -0,0 +1,249 @@
+#pragma once
+
+#include "fixed_name.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <cstdint>
+
+// Hash functions for FlatHashMap. CRC32 entry hashes are already uniformly distributed, so they are used as they are
+template<typename Key>
+struct FlatHash
+{
+    size_t operator()(const Key& key) const
+    {
+        return std::hash<Key>()(key);
+    }
+};
+
+template<>
+struct FlatHash<uint32_t>
+{
+    size_t operator()(uint32_t key) const
+    {
+        return key;
+    }
+};
+
+template<>
+struct FlatHash<FixedName8>
+{
+    size_t operator()(const FixedName8& name) const
+    {
+        // Names share their leading bytes, so the bits are mixed before taking the low ones
+        const uint64_t value = name.GetValue() * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(value ^ (value >> 32));
+    }
+};
+
+// Open-addressing hash map with linear probing for the entry texts of a table. All slots live in one array,
+// so loading a table allocates once (after reserve) instead of once per entry, and probing touches adjacent memory.
+// Entries can't be erased, which loaded entry maps never need.
+template<typename Key, typename Value, typename Hash = FlatHash<Key>>
+class FlatHashMap
+{
+public:
+    typedef std::pair<Key, Value>	value_type;
+
+    template<typename MapType, typename ValueType>
+    class IteratorBase
+    {
+    public:
+        IteratorBase(MapType* map, size_t index)
+            : _map(map), _index(index)
+        {
+            SkipEmptySlots();
+        }
+
+        ValueType& operator*() const
+        {
+            return _map->_slots[_index];
+        }
+        ValueType* operator->() const
+        {
+            return &_map->_slots[_index];
+        }
+        IteratorBase& operator++()
+        {
+            _index++;
+            SkipEmptySlots();
+            return *this;
+        }
+        bool operator==(const IteratorBase& rhs) const
+        {
+            return _index == rhs._index;
+        }
+        bool operator!=(const IteratorBase& rhs) const
+        {
+            return _index != rhs._index;
+        }
+
+    private:
+        void SkipEmptySlots()
+        {
+            while (_index < _map->_occupied.size() && !_map->_occupied[_index])
+            {
+                _index++;
+            }
+        }
+
+        friend class FlatHashMap;
+
+        MapType*	_map;
+        size_t		_index;
+    };
+
+    typedef IteratorBase<FlatHashMap, value_type>				iterator;
+    typedef IteratorBase<const FlatHashMap, const value_type>	const_iterator;
+
+    FlatHashMap()
+    {}
+
+    size_t size() const
+    {
+        return _size;
+    }
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    // Makes room for count entries without growing again
+    void reserve(size_t count)
+    {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity * MAX_LOAD_NUMERATOR < count * MAX_LOAD_DENOMINATOR)
+        {
+            capacity *= 2;
+        }
+        if (capacity > _slots.size())
+        {
+            Rehash(capacity);
+        }
+    }
+
+    void clear()
+    {
+        _slots.clear();
+        _occupied.clear();
+        _size = 0;
+    }
+
+    iterator begin()
+    {
+        return iterator(this, 0);
+    }
+    iterator end()
+    {
+        return iterator(this, _slots.size());
+    }
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const
+    {
+        return const_iterator(this, _slots.size());
+    }
+
+    iterator find(const Key& key)
+    {
+        return iterator(this, FindIndex(key));
+    }
+    const_iterator find(const Key& key) const
+    {
+        return const_iterator(this, FindIndex(key));
+    }
+
+    // Like std::unordered_map::emplace, an existing entry is kept
+    template<typename V>
+    std::pair<iterator, bool> emplace(const Key& key, V&& value)
+    {
+        if ((_size + 1) * MAX_LOAD_DENOMINATOR > _slots.size() * MAX_LOAD_NUMERATOR)
+        {
+            Rehash(_slots.empty() ? MIN_CAPACITY : _slots.size() * 2);
+        }
+
+        const size_t mask = _slots.size() - 1;
+        for (size_t index = Hash()(key) & mask;; index = (index + 1) & mask)
+        {
+            if (!_occupied[index])
+            {
+                _slots[index].first = key;
+                _slots[index].second = std::forward<V>(value);
+                _occupied[index] = 1;
+                _size++;
+                return std::make_pair(iterator(this, index), true);
+            }
+            if (_slots[index].first == key)
+            {
+                return std::make_pair(iterator(this, index), false);
+            }
+        }
+    }
+
+    Value& operator[](const Key& key)
+    {
+        auto itr = find(key);
+        if (itr != end())
+        {
+            return itr->second;
+        }
+        return emplace(key, Value()).first->second;
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 16;
+    // Grows when more than 3/4 of the slots are used
+    static constexpr size_t MAX_LOAD_NUMERATOR = 3;
+    static constexpr size_t MAX_LOAD_DENOMINATOR = 4;
+
+    // Returns _slots.size() if the key isn't in the map
+    size_t FindIndex(const Key& key) const
+    {
+        if (_size == 0)
+        {
+            return _slots.size();
+        }
+
+        const size_t mask = _slots.size() - 1;
+        for (size_t index = Hash()(key) & mask;; index = (index + 1) & mask)
+        {
+            if (!_occupied[index])
+            {
+                return _slots.size();
+            }
+            if (_slots[index].first == key)
+            {
+                return index;
+            }
+        }
+    }
+
+    void Rehash(size_t capacity)
+    {
+        std::vector<value_type> oldSlots(capacity);
+        std::vector<uint8_t> oldOccupied(capacity, 0);
+        oldSlots.swap(_slots);
+        oldOccupied.swap(_occupied);
+        _size = 0;
+
+        for (size_t i = 0; i < oldSlots.size(); i++)
+        {
+            if (oldOccupied[i])
+            {
+                emplace(oldSlots[i].first, std::move(oldSlots[i].second));
+            }
+        }
+    }
+
+    std::vector<value_type>		_slots;
+    std::vector<uint8_t>		_occupied;
+    size_t						_size = 0;
+};
+
+// Entry texts of hash-keyed (SA) and name-keyed (VC) tables
+typedef FlatHashMap<uint32_t, std::string>		HashEntryMap;
+typedef FlatHashMap<FixedName8, std::string>	NameEntryMap;
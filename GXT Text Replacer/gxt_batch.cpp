@@ -0,0 +1,243 @@
+#include "gxt_batch.h"
+#include "gxt_text_replacer.h"
+#include "utility.h"
+#include "diagnostic_log.h"
+#include "build_stats.h"
+#include "platform.h"
+#include "parallel.h"
+
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace
+{
+    // A GXT file the jobs replace the texts of, read once however many jobs use it
+    struct BatchInput
+    {
+        std::wstring							fileName;
+        GXTEnum::eGXTVersion					fileVersion;
+        std::unique_ptr<GXTTableCollection>		tableCollection;
+        size_t									jobCount = 0;
+        std::string								error;
+    };
+
+    std::vector<std::string> SplitFields(const std::string& line)
+    {
+        std::vector<std::string> fields;
+        std::string::size_type begin = 0;
+        while (true)
+        {
+            const std::string::size_type tabPos = line.find('\t', begin);
+            fields.push_back(line.substr(begin, tabPos == std::string::npos ? std::string::npos : tabPos - begin));
+            if (tabPos == std::string::npos)
+            {
+                return fields;
+            }
+            begin = tabPos + 1;
+        }
+    }
+
+    std::wstring ResolvePath(const std::filesystem::path& baseDirectory, const std::string& utf8Path)
+    {
+        return Platform::FromPath(baseDirectory / Platform::ToPath(Platform::ToWide(utf8Path, Platform::CODE_PAGE_UTF8)));
+    }
+
+    std::string ToUtf8(const std::wstring& text)
+    {
+        return Platform::FromWide(text, Platform::CODE_PAGE_UTF8);
+    }
+}
+
+std::vector<GXTBatchJob> GXTBatch::LoadManifest(const std::wstring& manifestFileName)
+{
+    std::ifstream manifestFile(Platform::ToPath(manifestFileName), std::ifstream::in);
+    if (!manifestFile.is_open())
+    {
+        throw std::runtime_error("Can't open the batch manifest " + ToUtf8(manifestFileName) + "!");
+    }
+    GXT_STATS_ADD(CounterFilesOpened, 1);
+
+    const std::filesystem::path baseDirectory = Platform::ToPath(manifestFileName).parent_path();
+
+    std::vector<GXTBatchJob> jobs;
+    std::set<std::filesystem::path> outputFileNames;
+
+    uint64_t lineCount = 0;
+    std::string fileLine;
+    while (std::getline(manifestFile, fileLine))
+    {
+        lineCount++;
+
+        if (lineCount == 1 && fileLine.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        {
+            fileLine.erase(0, 3);
+        }
+        if (!fileLine.empty() && fileLine.back() == '\r')
+        {
+            fileLine.pop_back();
+        }
+        if (fileLine.empty() || fileLine[0] == '#')
+        {
+            continue;
+        }
+
+        const std::string lineDescription = " in line " + std::to_string(lineCount) + " of " + ToUtf8(manifestFileName) + "!";
+        const std::vector<std::string> fields = SplitFields(fileLine);
+        if (fields.size() < 5 || fields.size() > 6 || fields[0].empty() || fields[1].empty())
+        {
+            throw std::runtime_error("Invalid batch job" + lineDescription);
+        }
+
+        GXTBatchJob job;
+        job.gxtFileName = ResolvePath(baseDirectory, fields[0]);
+        job.textDirectory = ResolvePath(baseDirectory, fields[1]);
+        job.outputFileName = (fields[4].empty() || fields[4] == "-") ? job.gxtFileName : ResolvePath(baseDirectory, fields[4]);
+
+        const std::string& mode = fields[2];
+        if (mode == "ansi")
+        {
+            job.textConvMode = GXTEnum::eTextConvertingMode::UseAnsi;
+        }
+        else if (mode == "unicode")
+        {
+            job.textConvMode = GXTEnum::eTextConvertingMode::UseUtf8OrUtf16;
+        }
+        else if (mode == "charmap" || mode.compare(0, 8, "charmap:") == 0)
+        {
+            job.textConvMode = GXTEnum::eTextConvertingMode::UseCharacterMap;
+            job.charMapFileName = ResolvePath(baseDirectory, mode.size() > 8 ? mode.substr(8) : std::string("charmap.txt"));
+        }
+        else
+        {
+            throw std::runtime_error("Unknown mode " + mode + lineDescription);
+        }
+
+        job.ansiCodePage = Platform::GetAnsiCodePage();
+        if (!fields[3].empty() && fields[3] != "-")
+        {
+            size_t parsedLength = 0;
+            try
+            {
+                job.ansiCodePage = std::stoi(fields[3], &parsedLength);
+            }
+            catch (std::exception&)
+            {
+                parsedLength = 0;
+            }
+            if (parsedLength != fields[3].size())
+            {
+                throw std::runtime_error("Invalid code page " + fields[3] + lineDescription);
+            }
+        }
+
+        if (fields.size() == 6 && fields[5] == "vc")
+        {
+            job.fileVersion = GXTEnum::eGXTVersion::GXT_VC;
+        }
+        else if (fields.size() == 6 && fields[5] == "sa16")
+        {
+            job.fileVersion = GXTEnum::eGXTVersion::GXT_SA_16BIT;
+        }
+        else if (fields.size() == 6 && fields[5] != "sa" && !fields[5].empty())
+        {
+            throw std::runtime_error("Unknown version " + fields[5] + lineDescription);
+        }
+
+        if (!outputFileNames.insert(Platform::ToPath(job.outputFileName).lexically_normal()).second)
+        {
+            throw std::runtime_error("The output " + ToUtf8(job.outputFileName) + " is written by more than one job" + lineDescription);
+        }
+
+        jobs.push_back(std::move(job));
+    }
+
+    if (jobs.empty())
+    {
+        throw std::runtime_error("The batch manifest " + ToUtf8(manifestFileName) + " has no jobs!");
+    }
+    return jobs;
+}
+
+std::vector<GXTBatchResult> GXTBatch::Run(const std::vector<GXTBatchJob>& jobs, DiagnosticLog& log)
+{
+    // Languages sharing the conversion settings share the converter, so every character map is parsed once
+    std::map<std::tuple<GXTEnum::eTextConvertingMode, int, std::wstring>, std::unique_ptr<TextConverter>> textConverters;
+    std::vector<const TextConverter*> jobConverters;
+    for (const auto& job : jobs)
+    {
+        auto& textConverter = textConverters[std::make_tuple(job.textConvMode, job.ansiCodePage, job.charMapFileName)];
+        if (!textConverter)
+        {
+            textConverter = std::make_unique<TextConverter>(job.textConvMode, job.ansiCodePage, job.charMapFileName);
+        }
+        jobConverters.push_back(textConverter.get());
+    }
+
+    // Languages replacing the texts of the same GXT file get copies of it instead of parsing it again
+    std::vector<BatchInput> inputs;
+    std::map<std::pair<std::filesystem::path, GXTEnum::eGXTVersion>, size_t> inputIndices;
+    std::vector<size_t> jobInputs;
+    for (const auto& job : jobs)
+    {
+        const auto key = std::make_pair(Platform::ToPath(job.gxtFileName).lexically_normal(), job.fileVersion);
+        auto itr = inputIndices.find(key);
+        if (itr == inputIndices.end())
+        {
+            itr = inputIndices.emplace(key, inputs.size()).first;
+            inputs.push_back(BatchInput{ job.gxtFileName, job.fileVersion });
+        }
+        inputs[itr->second].jobCount++;
+        jobInputs.push_back(itr->second);
+    }
+
+    Parallel::ForEachIndex(inputs.size(), [&](size_t i)
+    {
+        try
+        {
+            inputs[i].tableCollection = ReadGXTFile(inputs[i].fileName, inputs[i].fileVersion);
+        }
+        catch (std::exception& e)
+        {
+            inputs[i].error = e.what();
+        }
+    });
+
+    std::vector<GXTBatchResult> results(jobs.size());
+    Parallel::ForEachIndex(jobs.size(), [&](size_t i)
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        try
+        {
+            const BatchInput& input = inputs[jobInputs[i]];
+            if (!input.tableCollection)
+            {
+                throw std::runtime_error(input.error);
+            }
+
+            std::unique_ptr<GXTTableCollection> tableCollectionCopy;
+            GXTTableCollection* tableCollection = input.tableCollection.get();
+            if (input.jobCount > 1)
+            {
+                tableCollectionCopy = input.tableCollection->Clone();
+                tableCollection = tableCollectionCopy.get();
+            }
+
+            tableCollection->BulkReplaceText(jobs[i].textDirectory, *jobConverters[i], log);
+            tableCollection->WriteGXTFile(jobs[i].outputFileName);
+        }
+        catch (std::exception& e)
+        {
+            results[i].error = e.what();
+        }
+        results[i].milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    });
+
+    log.Flush();
+    return results;
+}
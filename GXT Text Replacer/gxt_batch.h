@@ -0,0 +1,44 @@
+#pragma once
+
+#include "enum.h"
+
+#include <string>
+#include <vector>
+
+class DiagnosticLog;
+
+// One language of a batch: the texts of textDirectory replace the ones of gxtFileName, which is written to outputFileName
+struct GXTBatchJob
+{
+    std::wstring					gxtFileName;
+    std::wstring					textDirectory;
+    std::wstring					outputFileName;
+    GXTEnum::eGXTVersion			fileVersion = GXTEnum::eGXTVersion::GXT_SA;
+    GXTEnum::eTextConvertingMode	textConvMode = GXTEnum::eTextConvertingMode::UseAnsi;
+    int								ansiCodePage = 0;
+    // Only used with UseCharacterMap
+    std::wstring					charMapFileName;
+};
+
+struct GXTBatchResult
+{
+    double			milliseconds = 0.0;
+    // Empty if the job succeeded
+    std::string		error;
+};
+
+// Replaces the texts of several languages in one process. The manifest has one
+// "[GXT file]\t[Text folder]\t[Mode]\t[Code page]\t[Output GXT]\t[Version]" line per language, lines starting with '#' are
+// comments. The mode is ansi, unicode, charmap or charmap:[file] (charmap.txt by default), the code page and output are
+// "-" for the system code page and for overwriting the GXT file, and the optional version is sa (default), sa16 or vc.
+// Paths are relative to the manifest.
+class GXTBatch
+{
+public:
+    // Throws std::runtime_error if the file can't be read, a line is invalid or two jobs write the same output
+    static std::vector<GXTBatchJob> LoadManifest(const std::wstring& manifestFileName);
+
+    // Every character map and code page is loaded once and every GXT file is read once, jobs sharing one get copies of it.
+    // The jobs then run on several threads, a failed job doesn't stop the others.
+    static std::vector<GXTBatchResult> Run(const std::vector<GXTBatchJob>& jobs, DiagnosticLog& log);
+};
@@ -0,0 +1,219 @@
+#include "gxt_builder.h"
+#include "gxt_text_replacer.h"
+#include "utility.h"
+#include "diagnostic_log.h"
+#include "build_stats.h"
+#include "platform.h"
+#include "parallel.h"
+
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <set>
+
+namespace
+{
+    std::string Trim(const std::string& text)
+    {
+        const std::string::size_type begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string::npos)
+        {
+            return std::string();
+        }
+        return text.substr(begin, text.find_last_not_of(" \t\r") - begin + 1);
+    }
+
+    std::string ToLower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+        return text;
+    }
+
+    std::string ToUtf8(const std::filesystem::path& path)
+    {
+        return Platform::FromWide(Platform::FromPath(path), Platform::CODE_PAGE_UTF8);
+    }
+
+    // Returns the path with every missing component replaced by an existing one that only differs in case, or the path itself
+    std::filesystem::path FindPathIgnoringCase(const std::filesystem::path& path)
+    {
+        namespace fs = std::filesystem;
+
+        std::error_code errorCode;
+        if (fs::exists(path, errorCode))
+        {
+            return path;
+        }
+
+        fs::path resolvedPath;
+        for (const auto& component : path)
+        {
+            fs::path nextPath = resolvedPath / component;
+            if (!fs::exists(nextPath, errorCode) && fs::is_directory(resolvedPath.empty() ? fs::path(".") : resolvedPath, errorCode))
+            {
+                const std::string lowerName = ToLower(ToUtf8(component));
+                for (const auto& entry : fs::directory_iterator(resolvedPath.empty() ? fs::path(".") : resolvedPath, errorCode))
+                {
+                    if (ToLower(ToUtf8(entry.path().filename())) == lowerName)
+                    {
+                        nextPath = resolvedPath / entry.path().filename();
+                        break;
+                    }
+                }
+            }
+            resolvedPath = nextPath;
+        }
+        return resolvedPath;
+    }
+
+    // The INI files are written on Windows, so both separators are accepted and the case of the names doesn't matter
+    std::wstring ResolvePath(const std::filesystem::path& baseDirectory, const std::string& utf8Path)
+    {
+        std::wstring path = Platform::ToWide(utf8Path, Platform::CODE_PAGE_UTF8);
+        std::replace_if(path.begin(), path.end(), [](wchar_t c) { return c == L'\\' || c == L'/'; }, Platform::PATH_SEPARATOR);
+        while (path.size() > 1 && path.back() == Platform::PATH_SEPARATOR)
+        {
+            path.pop_back();
+        }
+        return Platform::FromPath(FindPathIgnoringCase(baseDirectory / Platform::ToPath(path)));
+    }
+
+    std::string GetTableName(const std::wstring& tableDirectory)
+    {
+        const std::string tableName = ToUtf8(Platform::ToPath(tableDirectory).filename());
+        if (tableName.empty() || tableName.size() >= FixedName8::SIZE)
+        {
+            throw std::runtime_error("The table name " + tableName + " must have 1 to 7 characters!");
+        }
+        return tableName;
+    }
+}
+
+GXTProject GXTProject::Load(const std::wstring& iniFileName)
+{
+    std::ifstream inputFile(Platform::ToPath(iniFileName));
+    if (!inputFile.is_open())
+    {
+        throw std::runtime_error("Can't open " + Platform::FromWide(iniFileName, Platform::CODE_PAGE_UTF8) + "!");
+    }
+    GXT_STATS_ADD(CounterFilesOpened, 1);
+
+    const std::filesystem::path baseDirectory = Platform::ToPath(iniFileName).parent_path();
+
+    GXTProject project;
+    std::string section;
+    std::string fileLine;
+    while (std::getline(inputFile, fileLine))
+    {
+        // Skip the BOM
+        if (fileLine.compare(0, 3, "\xEF\xBB\xBF") == 0)
+        {
+            fileLine.erase(0, 3);
+        }
+
+        const std::string line = Trim(fileLine);
+        if (line.empty() || line[0] == ';' || line[0] == '#')
+        {
+            continue;
+        }
+
+        if (line.front() == '[' && line.back() == ']')
+        {
+            section = ToLower(line.substr(1, line.size() - 2));
+            continue;
+        }
+
+        if (section == "attribs")
+        {
+            const std::string::size_type equalsPos = line.find('=');
+            if (equalsPos == std::string::npos)
+            {
+                continue;
+            }
+
+            const std::string key = ToLower(Trim(line.substr(0, equalsPos)));
+            const std::string value = Trim(line.substr(equalsPos + 1));
+            if (key == "charmap")
+            {
+                project.charMapFileName = ResolvePath(baseDirectory, value);
+            }
+            else if (key == "version")
+            {
+                const std::string version = ToLower(value);
+                if (version == "sa")
+                    project.fileVersion = GXTEnum::eGXTVersion::GXT_SA;
+                else if (version == "sa16")
+                    project.fileVersion = GXTEnum::eGXTVersion::GXT_SA_16BIT;
+                else if (version == "vc")
+                    project.fileVersion = GXTEnum::eGXTVersion::GXT_VC;
+                else
+                    throw std::runtime_error("Unknown version " + value + "!");
+            }
+        }
+        else if (section == "tables")
+        {
+            project.tableDirectories.push_back(ResolvePath(baseDirectory, line));
+        }
+    }
+
+    if (project.tableDirectories.empty())
+    {
+        throw std::runtime_error("The project has no tables!");
+    }
+    return project;
+}
+
+std::unique_ptr<GXTTableCollection> GXTBuilder::Build(const GXTProject& project, GXTEnum::eGXTVersion fileVersion, const TextConverter& textConverter, DiagnosticLog& log)
+{
+    std::vector<std::string> tableNames;
+    std::set<std::string> uniqueTableNames;
+    for (const auto& tableDirectory : project.tableDirectories)
+    {
+        tableNames.push_back(GetTableName(tableDirectory));
+        if (!uniqueTableNames.insert(tableNames.back()).second)
+        {
+            throw std::runtime_error("The table " + tableNames.back() + " is listed more than once!");
+        }
+    }
+
+    auto tableCollection = std::make_unique<GXTTableCollection>(FixedName8(tableNames[0]), 0, fileVersion);
+    std::vector<GXTTableBlockInfo*> tables;
+    tables.push_back(&tableCollection->GetMainTable());
+    for (size_t i = 1; i < tableNames.size(); i++)
+    {
+        tableCollection->AddNewMissionTable(FixedName8(tableNames[i]), 0);
+        tables.push_back(tableCollection->FindTable(tableNames[i]));
+    }
+
+    Parallel::ForEachIndex(tables.size(), [&](size_t i)
+    {
+        GXT_STATS_TABLE(tableNames[i]);
+        const std::wstring& tableDirectory = project.tableDirectories[i];
+        if (!Directory::Exists(tableDirectory))
+        {
+            throw std::runtime_error("The table folder " + Platform::FromWide(tableDirectory, Platform::CODE_PAGE_UTF8) + " doesn't exist!");
+        }
+
+        GXTTableBase& table = *tables[i]->_GXTTable;
+        if (table.UsesHashForEntryName())
+        {
+            auto entryMap = EntryLoader::LoadHashEntryTextsInDirectory(tableDirectory, log);
+            textConverter.ConvertFromUtf8(entryMap, table.GetCharacterSize());
+
+            GXT_STATS_TIMER(PhaseReplaceEntries);
+            table.SetEntries(entryMap);
+        }
+        else
+        {
+            auto entryMap = EntryLoader::LoadEntryTextsInDirectory(tableDirectory, log);
+            textConverter.ConvertFromUtf8(entryMap, table.GetCharacterSize());
+
+            GXT_STATS_TIMER(PhaseReplaceEntries);
+            table.SetEntries(entryMap);
+        }
+    });
+
+    log.Flush();
+    return tableCollection;
+}
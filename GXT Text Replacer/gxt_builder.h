@@ -0,0 +1,34 @@
+#pragma once
+
+#include "enum.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <optional>
+
+class GXTTableCollection;
+class TextConverter;
+class DiagnosticLog;
+
+// A GXT builder project like doc/american.ini. [Attribs] has the character map file ("charmap") and the game ("version",
+// sa or vc, sa16 for SA files with 16-bit texts). [Tables] lists the text folders, the first one is the main table and
+// the folder names are the table names. Paths are relative to the INI file, lines starting with ';' or '#' are comments.
+struct GXTProject
+{
+    // Empty if the project has no character map
+    std::wstring						charMapFileName;
+    std::optional<GXTEnum::eGXTVersion>	fileVersion;
+    std::vector<std::wstring>			tableDirectories;
+
+    // Throws std::runtime_error if the file can't be read or has no tables
+    static GXTProject Load(const std::wstring& iniFileName);
+};
+
+// Creates a GXT file from text folders alone, without a GXT file to replace the texts of
+class GXTBuilder
+{
+public:
+    // Loads and converts the texts of the tables on several threads
+    static std::unique_ptr<GXTTableCollection> Build(const GXTProject& project, GXTEnum::eGXTVersion fileVersion, const TextConverter& textConverter, DiagnosticLog& log);
+};
@@ -0,0 +1,127 @@
+#include "gxt_extractor.h"
+#include "gxt_text_replacer.h"
+#include "utility.h"
+#include "diagnostic_log.h"
+#include "build_stats.h"
+#include "platform.h"
+#include "parallel.h"
+#include "utf8.h"
+
+#include <fstream>
+#include <filesystem>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    // The text file is written in pieces of about this size
+    constexpr size_t	WRITE_BUFFER_SIZE = 1 << 20;
+
+    // Returns why EntryLoader wouldn't read the text back as it is, or nullptr
+    const char* FindUnreadableText(const std::string& utf8Text)
+    {
+        if (utf8Text.find_first_of("\r\n") != std::string::npos)
+        {
+            return "The text contains a line break, the entry is left out.";
+        }
+        if (!utf8Text.empty() && utf8Text[0] == '\t')
+        {
+            return "The text starts with a tab, the entry is left out.";
+        }
+        if (!utf8::is_valid(utf8Text.begin(), utf8Text.end()))
+        {
+            return "The text doesn't convert to valid UTF-8, the entry is left out.";
+        }
+        return nullptr;
+    }
+
+    // Returns whether converting the UTF-8 text back gives the original TDAT bytes
+    bool ConvertsBack(const std::string& utf8Text, std::string_view content, const TextConverter& textConverter, size_t characterSize)
+    {
+        try
+        {
+            return textConverter.ConvertFromUtf8(utf8Text, characterSize) == content;
+        }
+        catch (std::exception&)
+        {
+            return false;
+        }
+    }
+
+    size_t ExtractTable(const GXTTableBlockInfo& tableInfo, const std::wstring& textDirectory, const TextConverter& textConverter, DiagnosticLog& log)
+    {
+        GXT_STATS_TABLE(tableInfo._tableName.ToString());
+        const GXTTableBase& table = *tableInfo._GXTTable;
+
+        const std::wstring tableName = Encoding::AnsiStringToWString(tableInfo._tableName.ToString());
+        const std::wstring tableDirectory = textDirectory + Platform::PATH_SEPARATOR + tableName;
+        const std::wstring fileName = tableDirectory + Platform::PATH_SEPARATOR + tableName + L".txt";
+
+        std::filesystem::create_directories(Platform::ToPath(tableDirectory));
+        std::ofstream outputFile(Platform::ToPath(fileName), std::ofstream::binary);
+        if (!outputFile.is_open())
+        {
+            throw std::runtime_error("Can't create " + Platform::FromWide(fileName, Platform::CODE_PAGE_UTF8) + "!");
+        }
+
+        std::string buffer;
+        buffer.reserve(WRITE_BUFFER_SIZE + 4096);
+        size_t entryCount = 0;
+
+        table.ForEachEntry([&](const std::string& entryName, std::string_view content)
+        {
+            std::string utf8Text;
+            {
+                GXT_STATS_TIMER(PhaseConvertEncoding);
+                utf8Text = textConverter.ConvertToUtf8(content, table.GetCharacterSize());
+            }
+
+            const char* problem = FindUnreadableText(utf8Text);
+            if (problem == nullptr && !ConvertsBack(utf8Text, content, textConverter, table.GetCharacterSize()))
+            {
+                problem = "The text doesn't convert back to the same bytes, the entry is left out.";
+            }
+            if (problem != nullptr)
+            {
+                log.Report(DiagnosticLog::SeverityWarning, fileName, 0, entryName, std::nullopt, problem);
+                return;
+            }
+
+            buffer += entryName;
+            buffer += '\t';
+            buffer += utf8Text;
+            buffer += '\n';
+            entryCount++;
+
+            if (buffer.size() >= WRITE_BUFFER_SIZE)
+            {
+                outputFile.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        });
+
+        outputFile.write(buffer.data(), buffer.size());
+        GXT_STATS_ADD(CounterBytesWritten, static_cast<uint64_t>(outputFile.tellp()));
+        return entryCount;
+    }
+}
+
+size_t GXTExtractor::Extract(GXTTableCollection& tableCollection, const std::wstring& textDirectory, const TextConverter& textConverter, DiagnosticLog& log)
+{
+    std::vector<const GXTTableBlockInfo*> tables;
+    tables.push_back(&tableCollection.GetMainTable());
+    for (const auto& missionTable : tableCollection.GetMissionTableMap())
+    {
+        tables.push_back(missionTable.second.get());
+    }
+
+    std::atomic<size_t> entryCount{ 0 };
+    Parallel::ForEachIndex(tables.size(), [&](size_t i)
+    {
+        entryCount += ExtractTable(*tables[i], textDirectory, textConverter, log);
+    });
+
+    log.Flush();
+    return entryCount;
+}
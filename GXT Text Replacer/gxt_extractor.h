@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+class GXTTableCollection;
+class TextConverter;
+class DiagnosticLog;
+
+// Writes the entries of every table to [Text folder]\[Table]\[Table].txt in the format EntryLoader reads, with the texts
+// converted back to UTF-8, so replacing with the extracted folder writes the same GXT file again. The tables are
+// extracted on several threads. Entries whose text wouldn't be read back unchanged, like texts with line breaks or
+// characters the code page or character map can't convert back, are left out and logged. Replacing keeps them as they are.
+class GXTExtractor
+{
+public:
+    // Returns the number of entries written
+    static size_t Extract(GXTTableCollection& tableCollection, const std::wstring& textDirectory, const TextConverter& textConverter, DiagnosticLog& log);
+};
@@ -0,0 +1,325 @@
+#include "gxt_index.h"
+#include "crc32keygen.h"
+#include "utility.h"
+#include "platform.h"
+
+#include <fstream>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+    constexpr uint32_t HEADER_SIZE = 4;
+    constexpr uint32_t BLOCK_SIZE_STORAGE_SIZE = 4;
+    constexpr uint32_t ONE_TABLE_BLOCK_SIZE = 12;
+
+    const std::array<const char, 4> INDEX_HEADER = { 'G', 'X', 'T', 'I' };
+
+    uint32_t ReadUInt32(const char* data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    void ThrowCorrupted(size_t offset)
+    {
+        throw std::runtime_error("The GXT file is corrupted! Offset: " + std::to_string(offset));
+    }
+
+    // Checks the 4-byte block header at offset and returns the block size stored after it
+    uint32_t ReadBlockHeader(const char* data, size_t size, size_t offset, const char* expectedHeader)
+    {
+        if (offset + HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE > size)
+        {
+            ThrowCorrupted(offset);
+        }
+        if (std::memcmp(data + offset, expectedHeader, HEADER_SIZE) != 0)
+        {
+            throw std::runtime_error(std::string("The ") + std::string(expectedHeader, HEADER_SIZE) + " header wasn't found! Offset: " + std::to_string(offset));
+        }
+        return ReadUInt32(data + offset + HEADER_SIZE);
+    }
+}
+
+size_t GXTLayout::GetEntrySize(GXTEnum::eGXTVersion fileVersion)
+{
+    // VC TKEY entries store an 8-byte name instead of a hash
+    return fileVersion == GXTEnum::eGXTVersion::GXT_VC ? sizeof(uint32_t) + TABLE_NAME_SIZE : sizeof(uint32_t) + sizeof(uint32_t);
+}
+
+size_t GXTLayout::GetCharacterSize(const char* data, size_t size, GXTEnum::eGXTVersion fileVersion)
+{
+    if (fileVersion == GXTEnum::eGXTVersion::GXT_VC)
+    {
+        return 2;
+    }
+    if (size < HEADER_SIZE)
+    {
+        ThrowCorrupted(0);
+    }
+    return ReadUInt32(data) == 0x100004 ? 2 : 1;
+}
+
+std::vector<GXTTableLayout> GXTLayout::ScanTables(const char* data, size_t size, GXTEnum::eGXTVersion fileVersion)
+{
+    size_t currentOffset = 0;
+
+    if (fileVersion != GXTEnum::eGXTVersion::GXT_VC)
+    {
+        if (size < HEADER_SIZE)
+        {
+            ThrowCorrupted(0);
+        }
+
+        const uint32_t headerValue = ReadUInt32(data);
+        if (headerValue != 0x080004 && headerValue != 0x100004)
+        {
+            throw std::runtime_error("Incorrect GXT version!");
+        }
+        if (fileVersion == GXTEnum::eGXTVersion::GXT_SA_16BIT && headerValue != 0x100004)
+        {
+            throw std::runtime_error("The GXT file doesn't have 16-bit texts!");
+        }
+        currentOffset += HEADER_SIZE;
+    }
+
+    const uint32_t TABLBlockSize = ReadBlockHeader(data, size, currentOffset, "TABL");
+    currentOffset += HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE;
+
+    if (TABLBlockSize < ONE_TABLE_BLOCK_SIZE || currentOffset + TABLBlockSize > size)
+    {
+        throw std::runtime_error("The GXT file is corrupted!");
+    }
+
+    const size_t ONE_ENTRY_SIZE = GetEntrySize(fileVersion);
+
+    std::vector<GXTTableLayout> tables;
+    tables.reserve(TABLBlockSize / ONE_TABLE_BLOCK_SIZE);
+
+    for (uint32_t i = 0; i + ONE_TABLE_BLOCK_SIZE <= TABLBlockSize; i += ONE_TABLE_BLOCK_SIZE)
+    {
+        const char* tableBlock = data + currentOffset + i;
+
+        GXTTableLayout table;
+        table.tableName = FixedName8::Read(tableBlock);
+
+        size_t tableOffset = ReadUInt32(tableBlock + TABLE_NAME_SIZE);
+
+        // Mission tables repeat their name before TKEY
+        if (i != 0)
+        {
+            if (tableOffset + TABLE_NAME_SIZE > size || std::memcmp(data + tableOffset, tableBlock, TABLE_NAME_SIZE) != 0)
+            {
+                throw std::runtime_error("The table name and TKEY header name does not equal! Offset: " + std::to_string(tableOffset));
+            }
+            tableOffset += TABLE_NAME_SIZE;
+        }
+
+        const uint32_t TKEYBlockSize = ReadBlockHeader(data, size, tableOffset, "TKEY");
+        table.entriesOffset = static_cast<uint32_t>(tableOffset + HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE);
+        table.entryCount = static_cast<uint32_t>(TKEYBlockSize / ONE_ENTRY_SIZE);
+
+        const size_t TDATOffset = table.entriesOffset + static_cast<size_t>(TKEYBlockSize);
+        table.contentSize = ReadBlockHeader(data, size, TDATOffset, "TDAT");
+        table.contentOffset = static_cast<uint32_t>(TDATOffset + HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE);
+
+        if (static_cast<size_t>(table.contentOffset) + table.contentSize > size)
+        {
+            ThrowCorrupted(TDATOffset);
+        }
+
+        tables.push_back(std::move(table));
+    }
+
+    return tables;
+}
+
+uint32_t GXTLayout::GetEntryKey(const char* data, const GXTTableLayout& table, size_t index, GXTEnum::eGXTVersion fileVersion)
+{
+    const char* entry = data + table.entriesOffset + index * GetEntrySize(fileVersion);
+    if (fileVersion == GXTEnum::eGXTVersion::GXT_VC)
+    {
+        char entryName[TABLE_NAME_SIZE + 1] = {};
+        std::memcpy(entryName, entry + sizeof(uint32_t), TABLE_NAME_SIZE);
+        return Crc32KeyGen::GetUppercaseKey(entryName);
+    }
+    return ReadUInt32(entry + sizeof(uint32_t));
+}
+
+uint32_t GXTLayout::GetEntryOffset(const char* data, const GXTTableLayout& table, size_t index, GXTEnum::eGXTVersion fileVersion)
+{
+    return ReadUInt32(data + table.entriesOffset + index * GetEntrySize(fileVersion));
+}
+
+std::wstring GXTIndex::GetIndexFileName(const std::wstring& gxtFileName)
+{
+    return Platform::FromPath(Platform::ToPath(gxtFileName).replace_extension(".gxtidx"));
+}
+
+int64_t GXTIndex::GetLastWriteTime(const std::wstring& fileName)
+{
+    return static_cast<int64_t>(std::filesystem::last_write_time(Platform::ToPath(fileName)).time_since_epoch().count());
+}
+
+void GXTIndex::Build(const std::wstring& gxtFileName, GXTEnum::eGXTVersion fileVersion)
+{
+    MappedFile gxtFile(gxtFileName);
+    const char* data = gxtFile.GetData();
+
+    const auto tables = GXTLayout::ScanTables(data, gxtFile.GetSize(), fileVersion);
+    const uint32_t characterSize = static_cast<uint32_t>(GXTLayout::GetCharacterSize(data, gxtFile.GetSize(), fileVersion));
+
+    Header header;
+    std::copy(INDEX_HEADER.cbegin(), INDEX_HEADER.cend(), header.magic);
+    header.formatVersion = INDEX_FORMAT_VERSION;
+    header.gxtFileSize = gxtFile.GetSize();
+    header.gxtLastWriteTime = GetLastWriteTime(gxtFileName);
+    header.gxtDigest = Digest::Compute(data, gxtFile.GetSize());
+    header.fileVersion = static_cast<uint32_t>(fileVersion);
+    header.tableCount = static_cast<uint32_t>(tables.size());
+
+    std::vector<GXTIndexTable> indexTables;
+    indexTables.reserve(tables.size());
+
+    size_t arrayOffset = sizeof(Header) + sizeof(GXTIndexTable) * tables.size();
+    for (const auto& table : tables)
+    {
+        GXTIndexTable indexTable;
+        table.tableName.Write(indexTable.tableName);
+        indexTable.entryCount = table.entryCount;
+        indexTable.contentOffset = table.contentOffset;
+        indexTable.contentSize = table.contentSize;
+        indexTable.keysOffset = static_cast<uint32_t>(arrayOffset);
+        indexTable.entryOffsetsOffset = static_cast<uint32_t>(arrayOffset + table.entryCount * sizeof(uint32_t));
+        indexTable.characterSize = characterSize;
+        indexTables.push_back(indexTable);
+
+        arrayOffset += table.entryCount * sizeof(uint32_t) * 2;
+    }
+
+    std::ofstream indexFile(Platform::ToPath(GetIndexFileName(gxtFileName)), std::ofstream::binary);
+    if (!indexFile.is_open())
+    {
+        const std::wstring indexFileName = GetIndexFileName(gxtFileName);
+        throw std::runtime_error("Can't create " + std::string(indexFileName.begin(), indexFileName.end()) + "!");
+    }
+
+    indexFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    indexFile.write(reinterpret_cast<const char*>(indexTables.data()), sizeof(GXTIndexTable) * indexTables.size());
+
+    using key = uint32_t;
+    using offset = uint32_t;
+
+    std::vector<std::pair<key, offset>> entries;
+    std::vector<uint32_t> arrayBuf;
+    for (const auto& table : tables)
+    {
+        entries.clear();
+        entries.reserve(table.entryCount);
+        for (size_t i = 0; i < table.entryCount; i++)
+        {
+            entries.emplace_back(GXTLayout::GetEntryKey(data, table, i, fileVersion), GXTLayout::GetEntryOffset(data, table, i, fileVersion));
+        }
+
+        // SA TKEY blocks are already sorted by hash, but VC ones are sorted by name
+        std::sort(entries.begin(), entries.end());
+
+        arrayBuf.resize(entries.size());
+        std::transform(entries.cbegin(), entries.cend(), arrayBuf.begin(), [](const auto& pair) { return pair.first; });
+        indexFile.write(reinterpret_cast<const char*>(arrayBuf.data()), arrayBuf.size() * sizeof(uint32_t));
+        std::transform(entries.cbegin(), entries.cend(), arrayBuf.begin(), [](const auto& pair) { return pair.second; });
+        indexFile.write(reinterpret_cast<const char*>(arrayBuf.data()), arrayBuf.size() * sizeof(uint32_t));
+    }
+}
+
+std::unique_ptr<GXTIndex> GXTIndex::Open(const std::wstring& gxtFileName, bool verifyDigest)
+{
+    namespace fs = std::filesystem;
+
+    const std::wstring indexFileName = GetIndexFileName(gxtFileName);
+    if (!fs::exists(Platform::ToPath(indexFileName)) || !fs::exists(Platform::ToPath(gxtFileName)))
+    {
+        return nullptr;
+    }
+
+    auto indexFile = std::make_unique<MappedFile>(indexFileName);
+    const char* data = indexFile->GetData();
+    const size_t size = indexFile->GetSize();
+
+    if (size < sizeof(Header))
+    {
+        return nullptr;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (!std::equal(INDEX_HEADER.cbegin(), INDEX_HEADER.cend(), header.magic) || header.formatVersion != INDEX_FORMAT_VERSION
+        || header.gxtFileSize != fs::file_size(Platform::ToPath(gxtFileName)) || header.gxtLastWriteTime != GetLastWriteTime(gxtFileName))
+    {
+        return nullptr;
+    }
+
+    if (verifyDigest)
+    {
+        MappedFile gxtFile(gxtFileName);
+        if (header.gxtDigest != Digest::Compute(gxtFile.GetData(), gxtFile.GetSize()))
+        {
+            return nullptr;
+        }
+    }
+
+    if (sizeof(Header) + static_cast<uint64_t>(header.tableCount) * sizeof(GXTIndexTable) > size)
+    {
+        return nullptr;
+    }
+
+    // Validate every array once, so lookups don't need any bounds checks
+    const GXTIndexTable* tables = reinterpret_cast<const GXTIndexTable*>(data + sizeof(Header));
+    for (size_t i = 0; i < header.tableCount; i++)
+    {
+        const uint64_t arraySize = static_cast<uint64_t>(tables[i].entryCount) * sizeof(uint32_t);
+        if (tables[i].keysOffset + arraySize > size || tables[i].entryOffsetsOffset + arraySize > size
+            || static_cast<uint64_t>(tables[i].contentOffset) + tables[i].contentSize > header.gxtFileSize)
+        {
+            return nullptr;
+        }
+    }
+
+    std::unique_ptr<GXTIndex> index(new GXTIndex(std::move(indexFile)));
+    index->_tables = tables;
+    index->_tableCount = header.tableCount;
+    return index;
+}
+
+GXTIndex::GXTIndex(std::unique_ptr<MappedFile> indexFile)
+    : _indexFile(std::move(indexFile))
+{
+}
+
+const GXTIndexTable* GXTIndex::FindTable(const std::string& tableName) const
+{
+    const FixedName8 name(tableName);
+
+    for (size_t i = 0; i < _tableCount; i++)
+    {
+        if (FixedName8::Read(_tables[i].tableName) == name)
+        {
+            return &_tables[i];
+        }
+    }
+    return nullptr;
+}
+
+const uint32_t* GXTIndex::GetKeys(const GXTIndexTable& table) const
+{
+    return reinterpret_cast<const uint32_t*>(_indexFile->GetData() + table.keysOffset);
+}
+
+const uint32_t* GXTIndex::GetEntryOffsets(const GXTIndexTable& table) const
+{
+    return reinterpret_cast<const uint32_t*>(_indexFile->GetData() + table.entryOffsetsOffset);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "enum.h"
+#include "mapped_file.h"
+#include "fixed_name.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+// Location of one table's TKEY and TDAT data inside a GXT file
+struct GXTTableLayout
+{
+    FixedName8		tableName;
+    uint32_t		entriesOffset = 0;
+    uint32_t		entryCount = 0;
+    uint32_t		contentOffset = 0;
+    uint32_t		contentSize = 0;
+};
+
+class GXTLayout
+{
+public:
+    static constexpr size_t TABLE_NAME_SIZE = FixedName8::SIZE;
+
+    // Walks TABL and every TKEY/TDAT header of a GXT file in memory without copying any entry
+    static std::vector<GXTTableLayout> ScanTables(const char* data, size_t size, GXTEnum::eGXTVersion fileVersion);
+    static size_t GetEntrySize(GXTEnum::eGXTVersion fileVersion);
+    // Returns 1 or 2 depending on the GXT header (VC GXT files always use 16-bit characters)
+    static size_t GetCharacterSize(const char* data, size_t size, GXTEnum::eGXTVersion fileVersion);
+    // Key of the TKEY entry at index (the CRC32 hash of the entry name for VC tables)
+    static uint32_t GetEntryKey(const char* data, const GXTTableLayout& table, size_t index, GXTEnum::eGXTVersion fileVersion);
+    static uint32_t GetEntryOffset(const char* data, const GXTTableLayout& table, size_t index, GXTEnum::eGXTVersion fileVersion);
+};
+
+// On-disk table record of a .gxtidx file
+struct GXTIndexTable
+{
+    char			tableName[GXTLayout::TABLE_NAME_SIZE];
+    uint32_t		entryCount;
+    uint32_t		contentOffset;
+    uint32_t		contentSize;
+    // Offsets in the index file of entryCount sorted keys and entryCount TDAT offsets (relative to contentOffset)
+    uint32_t		keysOffset;
+    uint32_t		entryOffsetsOffset;
+    uint32_t		characterSize;
+};
+
+// Pre-indexed sidecar (<name>.gxtidx) of a GXT file, keyed on the GXT file's size, last write time and digest.
+// Every table's keys are stored as a flat sorted array, so opening a GXT for lookups only validates the
+// header and maps the index file.
+class GXTIndex
+{
+public:
+    static std::wstring GetIndexFileName(const std::wstring& gxtFileName);
+
+    static void Build(const std::wstring& gxtFileName, GXTEnum::eGXTVersion fileVersion);
+    // Returns nullptr if the index doesn't exist or is stale. The GXT digest is only compared when verifyDigest is true
+    static std::unique_ptr<GXTIndex> Open(const std::wstring& gxtFileName, bool verifyDigest = false);
+
+    size_t GetNumTables() const
+    {
+        return _tableCount;
+    }
+    const GXTIndexTable& GetTable(size_t index) const
+    {
+        return _tables[index];
+    }
+    const GXTIndexTable* FindTable(const std::string& tableName) const;
+    const uint32_t* GetKeys(const GXTIndexTable& table) const;
+    const uint32_t* GetEntryOffsets(const GXTIndexTable& table) const;
+
+private:
+    struct Header
+    {
+        char			magic[4];
+        uint32_t		formatVersion;
+        uint64_t		gxtFileSize;
+        int64_t			gxtLastWriteTime;
+        uint64_t		gxtDigest;
+        uint32_t		fileVersion;
+        uint32_t		tableCount;
+    };
+
+    static const uint32_t INDEX_FORMAT_VERSION = 1;
+
+    explicit GXTIndex(std::unique_ptr<MappedFile> indexFile);
+    static int64_t GetLastWriteTime(const std::wstring& fileName);
+
+    std::unique_ptr<MappedFile>		_indexFile;
+    const GXTIndexTable*			_tables = nullptr;
+    size_t							_tableCount = 0;
+};
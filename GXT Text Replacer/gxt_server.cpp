@@ -0,0 +1,306 @@
+#include "gxt_server.h"
+#include "crc32keygen.h"
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+GXTServer::GXTServer(std::wstring gxtFileName, GXTEnum::eGXTVersion fileVersion, const TextConverter& textConverter, DiagnosticLog& log)
+    : _gxtFileName(std::move(gxtFileName)), _textConverter(textConverter), _log(log)
+{
+    _tableCollection = ReadGXTFile(_gxtFileName, fileVersion);
+}
+
+void GXTServer::Run(std::istream& input, std::ostream& output)
+{
+    std::string requestLine;
+    std::string responses;
+
+    bool running = true;
+    while (running && std::getline(input, requestLine))
+    {
+        if (requestLine.empty() || requestLine == "\r")
+        {
+            continue;
+        }
+
+        running = HandleRequest(requestLine, responses);
+
+        // Write out the whole batch once every request that's already buffered has been handled
+        if (!running || input.rdbuf()->in_avail() <= 0)
+        {
+            output << responses;
+            output.flush();
+            responses.clear();
+        }
+    }
+
+    output << responses;
+    output.flush();
+}
+
+bool GXTServer::HandleRequest(const std::string& requestLine, std::string& responses)
+{
+    std::string id = "null";
+    bool running = true;
+
+    try
+    {
+        const auto request = Json::ParseFlatObject(requestLine);
+
+        auto idItr = request.find("id");
+        if (idItr != request.end())
+        {
+            id = Json::ToJson(idItr->second);
+        }
+
+        const std::string& operation = GetString(request, "op");
+        std::string result;
+        if (operation == "get")
+        {
+            result = ",\"text\":" + Json::Escape(Get(request));
+        }
+        else if (operation == "set")
+        {
+            Set(request);
+        }
+        else if (operation == "replace")
+        {
+            Replace(request);
+        }
+        else if (operation == "flush")
+        {
+            Flush(request);
+        }
+        else if (operation == "quit")
+        {
+            running = false;
+        }
+        else
+        {
+            throw std::runtime_error("Unknown operation " + operation + "!");
+        }
+
+        responses += "{\"id\":" + id + ",\"ok\":true" + result + "}\n";
+    }
+    catch (std::exception& e)
+    {
+        responses += "{\"id\":" + id + ",\"ok\":false,\"error\":" + Json::Escape(e.what()) + "}\n";
+    }
+
+    return running;
+}
+
+const std::string& GXTServer::GetString(const std::unordered_map<std::string, JsonValue>& request, const char* name)
+{
+    auto itr = request.find(name);
+    if (itr == request.end() || !itr->second.isString)
+    {
+        throw std::runtime_error(std::string("The string member \"") + name + "\" is missing!");
+    }
+    return itr->second.value;
+}
+
+uint32_t GXTServer::GetEntryHash(const std::unordered_map<std::string, JsonValue>& request)
+{
+    const std::string& entryName = GetString(request, "key");
+
+    if (entryName.size() >= 3 && (entryName.compare(0, 2, "0x") == 0 || entryName.compare(0, 2, "0X") == 0))
+    {
+        auto hexValue = EntryLoader::HexStringToUInt32(entryName.substr(2));
+        if (hexValue == std::nullopt)
+        {
+            throw std::runtime_error("The entry name " + entryName + " has invalid hex value!");
+        }
+        return hexValue.value();
+    }
+
+    return Crc32KeyGen::GetUppercaseKey(entryName.c_str());
+}
+
+FixedName8 GXTServer::GetEntryName(const std::unordered_map<std::string, JsonValue>& request)
+{
+    std::string entryName = GetString(request, "key");
+    if (entryName.empty() || entryName.size() >= FixedName8::SIZE)
+    {
+        throw std::runtime_error("The entry name " + entryName + " must have 1 to 7 characters!");
+    }
+
+    // EntryLoader stores VC names in upper case too
+    std::transform(entryName.begin(), entryName.end(), entryName.begin(), ::toupper);
+    return FixedName8(entryName);
+}
+
+GXTTableBlockInfo& GXTServer::GetTable(const std::unordered_map<std::string, JsonValue>& request)
+{
+    const std::string& tableName = GetString(request, "table");
+
+    GXTTableBlockInfo* table = _tableCollection->FindTable(tableName);
+    if (table == nullptr)
+    {
+        throw std::runtime_error("The table " + tableName + " wasn't found!");
+    }
+    return *table;
+}
+
+void GXTServer::ApplyPendingEntries(GXTTableBlockInfo& table)
+{
+    auto itr = _pendingEntries.find(table._tableName);
+    if (itr != _pendingEntries.end())
+    {
+        if (table._GXTTable->UsesHashForEntryName())
+            table._GXTTable->ReplaceEntries(itr->second.hashEntries);
+        else
+            table._GXTTable->ReplaceEntries(itr->second.nameEntries);
+        _pendingEntries.erase(itr);
+    }
+}
+
+void GXTServer::ApplyAllPendingEntries()
+{
+    while (!_pendingEntries.empty())
+    {
+        ApplyPendingEntries(*_tableCollection->FindTable(_pendingEntries.begin()->first));
+    }
+}
+
+std::string GXTServer::Get(const std::unordered_map<std::string, JsonValue>& request)
+{
+    GXTTableBlockInfo& table = GetTable(request);
+    const GXTTableBase& GXTTable = *table._GXTTable;
+
+    ApplyPendingEntries(table);
+
+    std::string content;
+    const bool found = GXTTable.UsesHashForEntryName() ? GXTTable.FindEntryContent(GetEntryHash(request), content)
+        : GXTTable.FindEntryContent(GetEntryName(request), content);
+    if (!found)
+    {
+        throw std::runtime_error("The entry " + GetString(request, "key") + " wasn't found!");
+    }
+    return _textConverter.ConvertToUtf8(content, table._GXTTable->GetCharacterSize());
+}
+
+void GXTServer::Set(const std::unordered_map<std::string, JsonValue>& request)
+{
+    GXTTableBlockInfo& table = GetTable(request);
+
+    // Replacing only changes entries the table has, so a new key would be dropped without a word
+    std::string content;
+    if (table._GXTTable->UsesHashForEntryName())
+    {
+        const uint32_t entryHash = GetEntryHash(request);
+        if (!table._GXTTable->FindEntryContent(entryHash, content))
+        {
+            throw std::runtime_error("The entry " + GetString(request, "key") + " wasn't found!");
+        }
+
+        HashEntryMap entryMap;
+        entryMap.emplace(entryHash, GetString(request, "text"));
+        _textConverter.ConvertFromUtf8(entryMap, table._GXTTable->GetCharacterSize());
+
+        _pendingEntries[table._tableName].hashEntries[entryHash] = std::move(entryMap[entryHash]);
+    }
+    else
+    {
+        const FixedName8 entryName = GetEntryName(request);
+        if (!table._GXTTable->FindEntryContent(entryName, content))
+        {
+            throw std::runtime_error("The entry " + GetString(request, "key") + " wasn't found!");
+        }
+
+        NameEntryMap entryMap;
+        entryMap.emplace(entryName, GetString(request, "text"));
+        _textConverter.ConvertFromUtf8(entryMap, table._GXTTable->GetCharacterSize());
+
+        _pendingEntries[table._tableName].nameEntries[entryName] = std::move(entryMap[entryName]);
+    }
+}
+
+void GXTServer::Replace(const std::unordered_map<std::string, JsonValue>& request)
+{
+    ApplyAllPendingEntries();
+    _tableCollection->BulkReplaceText(Encoding::Utf8ToWString(GetString(request, "dir")), _textConverter, _log);
+}
+
+void GXTServer::Flush(const std::unordered_map<std::string, JsonValue>& request)
+{
+    ApplyAllPendingEntries();
+
+    auto pathItr = request.find("path");
+    if (pathItr != request.end())
+    {
+        _tableCollection->WriteGXTFile(Encoding::Utf8ToWString(GetString(request, "path")));
+    }
+    else
+    {
+        _tableCollection->WriteGXTFile(_gxtFileName);
+    }
+}
+
+void GXTServerBenchmark::Run(GXTServer& server, const std::string& tableName, size_t requestCount, size_t batchSize)
+{
+    using clock = std::chrono::steady_clock;
+
+    // 0xHASH for SA tables and names for VC ones
+    std::vector<std::string> entryNames;
+    const GXTTableBlockInfo* table = server.GetTableCollection().FindTable(tableName);
+    if (table != nullptr)
+    {
+        table->_GXTTable->ForEachEntry([&](const std::string& entryName, std::string_view)
+        {
+            entryNames.push_back(entryName);
+        });
+    }
+
+    if (entryNames.empty())
+    {
+        throw std::runtime_error("The table " + tableName + " wasn't found or has no entries!");
+    }
+
+    std::vector<std::string> requests;
+    requests.reserve(requestCount);
+    for (size_t i = 0; i < requestCount; i++)
+    {
+        std::ostringstream request;
+        request << "{\"id\":" << i << ",\"op\":\"" << (i % 16 == 15 ? "set" : "get") << "\",\"table\":\"" << tableName
+            << "\",\"key\":\"" << entryNames[i % entryNames.size()] << "\""
+            << (i % 16 == 15 ? ",\"text\":\"benchmark\"" : "") << "}";
+        requests.push_back(request.str());
+    }
+
+    // Every request of a batch is answered when the batch's responses are written out
+    std::vector<double> latencies;
+    latencies.reserve(requestCount);
+
+    std::string responses;
+    const auto startTime = clock::now();
+    for (size_t batchStart = 0; batchStart < requestCount; batchStart += batchSize)
+    {
+        const size_t batchEnd = (std::min)(batchStart + batchSize, requestCount);
+        const auto batchStartTime = clock::now();
+
+        for (size_t i = batchStart; i < batchEnd; i++)
+        {
+            server.HandleRequest(requests[i], responses);
+        }
+        responses.clear();
+
+        const double batchLatency = std::chrono::duration<double, std::micro>(clock::now() - batchStartTime).count();
+        latencies.insert(latencies.end(), batchEnd - batchStart, batchLatency);
+    }
+    const double totalSeconds = std::chrono::duration<double>(clock::now() - startTime).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p)
+    {
+        return latencies[(std::min)(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))];
+    };
+
+    std::cout << "Requests:      " << requestCount << " (batches of " << batchSize << ")\n"
+        << "Requests/s:    " << static_cast<uint64_t>(requestCount / totalSeconds) << "\n"
+        << "p50 latency:   " << percentile(0.50) << " us\n"
+        << "p99 latency:   " << percentile(0.99) << " us\n";
+}
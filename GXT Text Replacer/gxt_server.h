@@ -0,0 +1,72 @@
+#pragma once
+
+#include "gxt_text_replacer.h"
+#include "utility.h"
+#include "json.h"
+
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <iosfwd>
+
+// Keeps a GXT file, its tables and the text converter resident and answers newline-delimited JSON requests:
+//   {"id":1,"op":"get","table":"MAIN","key":"TEST1"}             -> {"id":1,"ok":true,"text":"..."}
+//   {"id":2,"op":"set","table":"MAIN","key":"0x1234ABCD","text":"..."}
+// (SA keys are names or 0xHASH, VC keys are names)
+//   {"id":3,"op":"replace","dir":"text\\folder"}
+//   {"id":4,"op":"flush"} (or "path" to write the GXT file somewhere else)
+//   {"id":5,"op":"quit"}
+// Responses of requests that are already buffered are written out together, and consecutive "set" requests
+// for a table are applied with a single ReplaceEntries call right before the table is read or written.
+class GXTServer
+{
+public:
+    GXTServer(std::wstring gxtFileName, GXTEnum::eGXTVersion fileVersion, const TextConverter& textConverter, DiagnosticLog& log);
+
+    // Serves requests until the input ends or a "quit" request arrives
+    void Run(std::istream& input, std::ostream& output);
+    // Handles one request line and appends its response line to responses. Returns false after "quit"
+    bool HandleRequest(const std::string& requestLine, std::string& responses);
+
+    GXTTableCollection& GetTableCollection()
+    {
+        return *_tableCollection;
+    }
+
+private:
+    std::string Get(const std::unordered_map<std::string, JsonValue>& request);
+    void Set(const std::unordered_map<std::string, JsonValue>& request);
+    void Replace(const std::unordered_map<std::string, JsonValue>& request);
+    void Flush(const std::unordered_map<std::string, JsonValue>& request);
+
+    GXTTableBlockInfo& GetTable(const std::unordered_map<std::string, JsonValue>& request);
+    void ApplyPendingEntries(GXTTableBlockInfo& table);
+    void ApplyAllPendingEntries();
+
+    static const std::string& GetString(const std::unordered_map<std::string, JsonValue>& request, const char* name);
+    static uint32_t GetEntryHash(const std::unordered_map<std::string, JsonValue>& request);
+    static FixedName8 GetEntryName(const std::unordered_map<std::string, JsonValue>& request);
+
+    std::wstring							_gxtFileName;
+    const TextConverter&					_textConverter;
+    DiagnosticLog&							_log;
+    std::unique_ptr<GXTTableCollection>		_tableCollection;
+
+    // Converted texts of "set" requests that haven't been applied yet, hash-keyed for SA tables and name-keyed for VC ones
+    struct PendingEntries
+    {
+        HashEntryMap	hashEntries;
+        NameEntryMap	nameEntries;
+    };
+
+    std::map<FixedName8, PendingEntries>	_pendingEntries;
+};
+
+// Drives a GXTServer in-process with "get" requests (and a "set" every 16th request) for the entries of a table,
+// and reports requests per second and latency percentiles. Requests are sent in batches like a client would pipeline them.
+class GXTServerBenchmark
+{
+public:
+    static void Run(GXTServer& server, const std::string& tableName, size_t requestCount, size_t batchSize);
+};
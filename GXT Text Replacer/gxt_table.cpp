@@ -0,0 +1,641 @@
+#include "gxt_table.h"
+#include "radix_sort.h"
+#include "build_stats.h"
+#include "build_trace.h"
+#include "crc32keygen.h"
+#include "parallel.h"
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+template<typename Traits>
+size_t GXTTable<Traits>::FindTerminator(size_t offset) const
+{
+    const size_t contentSize = FormattedContent.size() - FormattedContent.size() % sizeof(character_t);
+    const char* content = FormattedContent.data();
+
+    for (; offset < contentSize; offset += sizeof(character_t))
+    {
+        if (*reinterpret_cast<const character_t*>(content + offset) == 0)
+        {
+            return offset;
+        }
+    }
+    return FormattedContent.size();
+}
+
+// Integer keys for radix sorting, ordered like the TKEY keys
+static uint32_t GetSortKey(uint32_t hash)
+{
+    return hash;
+}
+
+static uint64_t GetSortKey(const FixedName8& name)
+{
+    return name.GetValue();
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::UsesSortMerge() const
+{
+    switch (_replaceStrategy)
+    {
+    case GXTEnum::eReplaceStrategy::ReplaceHashProbe:
+        return false;
+    case GXTEnum::eReplaceStrategy::ReplaceSortMerge:
+        return true;
+    default:
+        return Entries.size() >= SORT_MERGE_MIN_ENTRIES;
+    }
+}
+
+template<typename Traits>
+template<typename Map>
+void GXTTable<Traits>::CollectByHashProbe(const Map& entryMap, std::vector<ContentEntry>& contentEntries)
+{
+    for (auto& entryPair : Entries)
+    {
+        auto itr = entryMap.find(entryPair.first);
+        contentEntries.push_back({ entryPair.second, &entryPair.second, itr != entryMap.end() ? &itr->second : nullptr });
+    }
+
+    std::stable_sort(contentEntries.begin(), contentEntries.end(), [](const ContentEntry& lhs, const ContentEntry& rhs)
+    {
+        return lhs.originalOffset < rhs.originalOffset;
+    });
+}
+
+template<typename Traits>
+template<typename Map>
+void GXTTable<Traits>::CollectBySortMerge(const Map& entryMap, std::vector<ContentEntry>& contentEntries)
+{
+    typedef decltype(GetSortKey(key_t()))	sort_key_t;
+
+    std::vector<std::pair<sort_key_t, const std::string*>> replacements;
+    replacements.reserve(entryMap.size());
+    for (const auto& entryPair : entryMap)
+    {
+        replacements.emplace_back(GetSortKey(entryPair.first), &entryPair.second);
+    }
+    RadixSort(replacements, [](const std::pair<sort_key_t, const std::string*>& replacement)
+    {
+        return replacement.first;
+    });
+
+    // Entries is ordered by key too, so one pass over both marks the replaced entries
+    auto replacement = replacements.cbegin();
+    for (auto& entryPair : Entries)
+    {
+        const sort_key_t sortKey = GetSortKey(entryPair.first);
+        while (replacement != replacements.cend() && replacement->first < sortKey)
+        {
+            ++replacement;
+        }
+
+        const bool replaced = replacement != replacements.cend() && replacement->first == sortKey;
+        contentEntries.push_back({ entryPair.second, &entryPair.second, replaced ? replacement->second : nullptr });
+    }
+
+    RadixSort(contentEntries, [](const ContentEntry& contentEntry)
+    {
+        return contentEntry.originalOffset;
+    });
+}
+
+// Entry names as the text files spell them: 0x followed by 8 upper case hex digits, or the VC name
+static std::string FormatEntryName(uint32_t hash)
+{
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+    std::string entryName = "0x00000000";
+    for (size_t i = 0; i < 8; i++)
+    {
+        entryName[9 - i] = HEX_DIGITS[(hash >> (i * 4)) & 0xF];
+    }
+    return entryName;
+}
+
+static std::string FormatEntryName(const FixedName8& name)
+{
+    return name.ToString();
+}
+
+template<typename Traits>
+void GXTTable<Traits>::RebuildContent(const std::vector<ContentEntry>& contentEntries)
+{
+    const size_t chunkCount = _rebuildChunkCount != 0 ? _rebuildChunkCount
+        : (std::min)(static_cast<size_t>(std::thread::hardware_concurrency()), contentEntries.size() / PARALLEL_REBUILD_MIN_CHUNK_ENTRIES);
+    if (chunkCount > 1)
+    {
+        RebuildContentInParallel(contentEntries, chunkCount);
+        return;
+    }
+
+    const character_t terminator = 0;
+
+    std::string newFormattedStr;
+    newFormattedStr.reserve(FormattedContent.size());
+    for (const auto& contentEntry : contentEntries)
+    {
+        if (contentEntry.sharedText != nullptr)
+        {
+            *contentEntry.newOffset = *contentEntry.sharedText->newOffset;
+            continue;
+        }
+
+        *contentEntry.newOffset = static_cast<uint32_t>(newFormattedStr.size());
+
+        if (contentEntry.replacement != nullptr)
+        {
+            newFormattedStr += *contentEntry.replacement;
+        }
+        else if (contentEntry.originalOffset < FormattedContent.size())
+        {
+            newFormattedStr.append(FormattedContent, contentEntry.originalOffset, FindTerminator(contentEntry.originalOffset) - contentEntry.originalOffset);
+        }
+        newFormattedStr.append(reinterpret_cast<const char*>(&terminator), sizeof(terminator));
+    }
+    FormattedContent = std::move(newFormattedStr);
+}
+
+template<typename Traits>
+void GXTTable<Traits>::RebuildContentInParallel(const std::vector<ContentEntry>& contentEntries, size_t chunkCount)
+{
+    const size_t chunkEntries = (contentEntries.size() + chunkCount - 1) / chunkCount;
+
+    // First every chunk measures its texts, then the chunks copy them to the offsets given by the prefix sum
+    // of the chunk sizes. The entries are written in the same order as the serial rebuild, so the result is identical.
+    std::vector<uint32_t> textSizes(contentEntries.size());
+    std::vector<size_t> chunkOffsets(chunkCount + 1, 0);
+
+    Parallel::ForEachIndex(chunkCount, [&](size_t chunk)
+    {
+        GXT_TRACE_SCOPE("measure_chunk", "worker");
+
+        const size_t begin = (std::min)(chunk * chunkEntries, contentEntries.size());
+        const size_t end = (std::min)(begin + chunkEntries, contentEntries.size());
+
+        size_t chunkSize = 0;
+        for (size_t i = begin; i < end; i++)
+        {
+            const ContentEntry& contentEntry = contentEntries[i];
+            if (contentEntry.sharedText != nullptr)
+            {
+                continue;
+            }
+            if (contentEntry.replacement != nullptr)
+            {
+                textSizes[i] = static_cast<uint32_t>(contentEntry.replacement->size());
+            }
+            else if (contentEntry.originalOffset < FormattedContent.size())
+            {
+                textSizes[i] = static_cast<uint32_t>(FindTerminator(contentEntry.originalOffset) - contentEntry.originalOffset);
+            }
+            chunkSize += textSizes[i] + sizeof(character_t);
+        }
+        chunkOffsets[chunk + 1] = chunkSize;
+    });
+
+    for (size_t chunk = 0; chunk < chunkCount; chunk++)
+    {
+        chunkOffsets[chunk + 1] += chunkOffsets[chunk];
+    }
+
+    std::string newFormattedStr(chunkOffsets[chunkCount], '\0');
+
+    Parallel::ForEachIndex(chunkCount, [&](size_t chunk)
+    {
+        GXT_TRACE_SCOPE("copy_chunk", "worker");
+
+        const size_t begin = (std::min)(chunk * chunkEntries, contentEntries.size());
+        const size_t end = (std::min)(begin + chunkEntries, contentEntries.size());
+
+        // The buffer is zero-filled, so skipping past the text leaves its terminator
+        size_t offset = chunkOffsets[chunk];
+        for (size_t i = begin; i < end; i++)
+        {
+            const ContentEntry& contentEntry = contentEntries[i];
+            if (contentEntry.sharedText != nullptr)
+            {
+                continue;
+            }
+            *contentEntry.newOffset = static_cast<uint32_t>(offset);
+
+            const char* text = contentEntry.replacement != nullptr ? contentEntry.replacement->data() : FormattedContent.data() + contentEntry.originalOffset;
+            std::copy_n(text, textSizes[i], &newFormattedStr[offset]);
+            offset += textSizes[i] + sizeof(character_t);
+        }
+    });
+
+    // The text an entry shares may have been copied by another chunk
+    for (const auto& contentEntry : contentEntries)
+    {
+        if (contentEntry.sharedText != nullptr)
+        {
+            *contentEntry.newOffset = *contentEntry.sharedText->newOffset;
+        }
+    }
+
+    FormattedContent = std::move(newFormattedStr);
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::IsOriginalText(uint32_t offset, const std::string& text) const
+{
+    return offset < FormattedContent.size() && FormattedContent.compare(offset, text.size(), text) == 0 && FindTerminator(offset) == offset + text.size();
+}
+
+template<typename Traits>
+void GXTTable<Traits>::ShareUnchangedTexts(std::vector<ContentEntry>& contentEntries) const
+{
+    // Entries sharing an original offset are next to each other, replaced ones may be in between
+    const ContentEntry* keptText = nullptr;
+    for (auto& contentEntry : contentEntries)
+    {
+        if (contentEntry.replacement != nullptr && IsOriginalText(contentEntry.originalOffset, *contentEntry.replacement))
+        {
+            contentEntry.replacement = nullptr;
+        }
+        if (contentEntry.replacement != nullptr)
+        {
+            continue;
+        }
+
+        if (keptText != nullptr && keptText->originalOffset == contentEntry.originalOffset)
+        {
+            contentEntry.sharedText = keptText;
+        }
+        else
+        {
+            keptText = &contentEntry;
+        }
+    }
+}
+
+template<typename Traits>
+template<typename Map>
+bool GXTTable<Traits>::ReplaceEntriesImpl(const Map& entryMap)
+{
+    if (entryMap.size() == 0)
+    {
+        return false;
+    }
+
+    std::vector<ContentEntry> contentEntries;
+    contentEntries.reserve(Entries.size());
+
+    if (UsesSortMerge())
+    {
+        CollectBySortMerge(entryMap, contentEntries);
+    }
+    else
+    {
+        CollectByHashProbe(entryMap, contentEntries);
+    }
+    ShareUnchangedTexts(contentEntries);
+
+    GXT_STATS_ADD(CounterEntriesReplaced, std::count_if(contentEntries.begin(), contentEntries.end(), [](const ContentEntry& contentEntry)
+    {
+        return contentEntry.replacement != nullptr;
+    }));
+
+    RebuildContent(contentEntries);
+
+    return true;
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::ReplaceEntries(const NameEntryMap& entryMap)
+{
+    if constexpr (Traits::USES_HASH_FOR_ENTRY_NAME)
+    {
+        return false;
+    }
+    else
+    {
+        return ReplaceEntriesImpl(entryMap);
+    }
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::ReplaceEntries(const HashEntryMap& entryMap)
+{
+    if constexpr (Traits::USES_HASH_FOR_ENTRY_NAME)
+    {
+        return ReplaceEntriesImpl(entryMap);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+template<typename Traits>
+template<typename Map>
+void GXTTable<Traits>::SetEntriesImpl(const Map& entryMap)
+{
+    std::vector<std::pair<key_t, const std::string*>> sortedEntries;
+    sortedEntries.reserve(entryMap.size());
+    size_t contentSize = 0;
+    for (const auto& entryPair : entryMap)
+    {
+        sortedEntries.emplace_back(entryPair.first, &entryPair.second);
+        contentSize += entryPair.second.size() + sizeof(character_t);
+    }
+    std::sort(sortedEntries.begin(), sortedEntries.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.first < rhs.first;
+    });
+
+    const character_t terminator = 0;
+
+    Entries.clear();
+    FormattedContent.clear();
+    FormattedContent.reserve(contentSize);
+    for (const auto& entryPair : sortedEntries)
+    {
+        Entries.emplace_hint(Entries.end(), entryPair.first, static_cast<uint32_t>(FormattedContent.size()));
+        FormattedContent += *entryPair.second;
+        FormattedContent.append(reinterpret_cast<const char*>(&terminator), sizeof(terminator));
+    }
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::SetEntries(const NameEntryMap& entryMap)
+{
+    if constexpr (Traits::USES_HASH_FOR_ENTRY_NAME)
+    {
+        return false;
+    }
+    else
+    {
+        SetEntriesImpl(entryMap);
+        return true;
+    }
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::SetEntries(const HashEntryMap& entryMap)
+{
+    if constexpr (Traits::USES_HASH_FOR_ENTRY_NAME)
+    {
+        SetEntriesImpl(entryMap);
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+template<typename Traits>
+template<typename Map>
+size_t GXTTable<Traits>::GetReplacedFormattedContentSizeImpl(const Map& entryMap) const
+{
+    if (entryMap.size() == 0)
+    {
+        return FormattedContent.size();
+    }
+
+    // Like RebuildContent, replaced entries get their own copy of their text and the kept texts are written once
+    size_t contentSize = 0;
+    std::vector<uint32_t> keptOffsets;
+    keptOffsets.reserve(Entries.size());
+    for (const auto& entryPair : Entries)
+    {
+        auto itr = entryMap.find(entryPair.first);
+        if (itr != entryMap.end() && !IsOriginalText(entryPair.second, itr->second))
+        {
+            contentSize += itr->second.size() + sizeof(character_t);
+        }
+        else
+        {
+            keptOffsets.push_back(entryPair.second);
+        }
+    }
+
+    std::sort(keptOffsets.begin(), keptOffsets.end());
+    keptOffsets.erase(std::unique(keptOffsets.begin(), keptOffsets.end()), keptOffsets.end());
+    for (const uint32_t offset : keptOffsets)
+    {
+        if (offset < FormattedContent.size())
+        {
+            contentSize += FindTerminator(offset) - offset;
+        }
+        contentSize += sizeof(character_t);
+    }
+    return contentSize;
+}
+
+template<typename Traits>
+size_t GXTTable<Traits>::GetReplacedFormattedContentSize(const NameEntryMap& entryMap) const
+{
+    if constexpr (Traits::USES_HASH_FOR_ENTRY_NAME)
+    {
+        return FormattedContent.size();
+    }
+    else
+    {
+        return GetReplacedFormattedContentSizeImpl(entryMap);
+    }
+}
+
+template<typename Traits>
+size_t GXTTable<Traits>::GetReplacedFormattedContentSize(const HashEntryMap& entryMap) const
+{
+    if constexpr (Traits::USES_HASH_FOR_ENTRY_NAME)
+    {
+        return GetReplacedFormattedContentSizeImpl(entryMap);
+    }
+    else
+    {
+        return FormattedContent.size();
+    }
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::FindEntryContent(const uint32_t crc32EntryHash, std::string& content) const
+{
+    if constexpr (Traits::USES_HASH_FOR_ENTRY_NAME)
+    {
+        auto itr = Entries.find(crc32EntryHash);
+        return itr != Entries.end() && CopyContent(itr->second, content);
+    }
+    else
+    {
+        return false;
+    }
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::FindEntryContent(const FixedName8& entryName, std::string& content) const
+{
+    if constexpr (Traits::USES_HASH_FOR_ENTRY_NAME)
+    {
+        return FindEntryContent(Crc32KeyGen::GetUppercaseKey(entryName.ToString().c_str()), content);
+    }
+    else
+    {
+        auto itr = Entries.find(entryName);
+        return itr != Entries.end() && CopyContent(itr->second, content);
+    }
+}
+
+template<typename Traits>
+bool GXTTable<Traits>::CopyContent(uint32_t offset, std::string& content) const
+{
+    if (offset > FormattedContent.size())
+    {
+        return false;
+    }
+
+    content.assign(FormattedContent, offset, FindTerminator(offset) - offset);
+    return true;
+}
+
+template<typename Traits>
+std::vector<std::pair<std::string, size_t>> GXTTable<Traits>::GetLargestEntries(size_t count) const
+{
+    std::vector<std::pair<size_t, key_t>> entrySizes;
+    entrySizes.reserve(Entries.size());
+    for (const auto& entryPair : Entries)
+    {
+        const size_t textSize = entryPair.second < FormattedContent.size() ? FindTerminator(entryPair.second) - entryPair.second : 0;
+        entrySizes.emplace_back(textSize + sizeof(character_t), entryPair.first);
+    }
+
+    count = (std::min)(count, entrySizes.size());
+    std::partial_sort(entrySizes.begin(), entrySizes.begin() + count, entrySizes.end(), [](const auto& lhs, const auto& rhs)
+    {
+        return lhs.first > rhs.first;
+    });
+
+    std::vector<std::pair<std::string, size_t>> largestEntries;
+    for (size_t i = 0; i < count; i++)
+    {
+        largestEntries.emplace_back(FormatEntryName(entrySizes[i].second), entrySizes[i].first);
+    }
+    return largestEntries;
+}
+
+template<typename Traits>
+void GXTTable<Traits>::ForEachEntry(const EntryVisitor& visitor) const
+{
+    const std::string_view content(FormattedContent);
+    for (const auto& entryPair : Entries)
+    {
+        const size_t textSize = entryPair.second < FormattedContent.size() ? FindTerminator(entryPair.second) - entryPair.second : 0;
+        visitor(FormatEntryName(entryPair.first), content.substr((std::min)(static_cast<size_t>(entryPair.second), content.size()), textSize));
+    }
+}
+
+template<typename Traits>
+size_t GXTTable<Traits>::ReadTKEYAndTDATBlock(std::istream& inputStream, const uint32_t offset)
+{
+    constexpr uint32_t HEADER_SIZE = 4;
+    constexpr uint32_t BLOCK_SIZE_STORAGE_SIZE = 4;
+
+    std::array<char, HEADER_SIZE> headerBuf;
+    static const std::array<const char, HEADER_SIZE> HEADER_TKEY = { 'T', 'K', 'E', 'Y' };
+    static const std::array<const char, HEADER_SIZE> HEADER_TDAT = { 'T', 'D', 'A', 'T' };
+
+    inputStream.seekg(offset, std::ios_base::beg);
+    inputStream.read(headerBuf.data(), HEADER_SIZE);
+
+    if (!std::equal(headerBuf.cbegin(), headerBuf.cend(), HEADER_TKEY.cbegin()))
+    {
+        throw std::runtime_error("The TKEY header wasn't found!");
+    }
+
+    uint32_t TKEYBlockSize = 0;
+    inputStream.read(reinterpret_cast<char *>(&TKEYBlockSize), BLOCK_SIZE_STORAGE_SIZE);
+
+    // The whole TKEY block is read at once and parsed from memory
+    std::vector<char> entryBuffer(TKEYBlockSize);
+    inputStream.read(entryBuffer.data(), TKEYBlockSize);
+
+    for (size_t i = 0; i + Traits::ENTRY_SIZE <= TKEYBlockSize; i += Traits::ENTRY_SIZE)
+    {
+        const char* entry = entryBuffer.data() + i;
+        Entries.emplace_hint(Entries.end(), Traits::ReadKey(entry), *reinterpret_cast<const uint32_t*>(entry));
+    }
+
+    inputStream.read(headerBuf.data(), HEADER_SIZE);
+
+    if (!inputStream || !std::equal(headerBuf.cbegin(), headerBuf.cend(), HEADER_TDAT.cbegin()))
+    {
+        std::string errorStr = std::string("The TDAT header wasn't found! Offset: ");
+        errorStr.append(std::to_string(offset + HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE + TKEYBlockSize));
+        errorStr.append("\n");
+        throw std::runtime_error(errorStr);
+    }
+
+    uint32_t TDATBlockSize = 0;
+    inputStream.read(reinterpret_cast<char *>(&TDATBlockSize), BLOCK_SIZE_STORAGE_SIZE);
+
+    FormattedContent.resize(TDATBlockSize);
+    inputStream.read(&FormattedContent[0], TDATBlockSize);
+
+    return TKEYBlockSize + TDATBlockSize + (HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE) * 2;
+}
+
+template<typename Traits>
+void GXTTable<Traits>::WriteTKEYAndTDATBlock(std::ostream& stream) const
+{
+    {
+        const char		header[] = { 'T', 'K', 'E', 'Y' };
+        stream.write(header, sizeof(header));
+        const uint32_t	dwBlockSize = static_cast<uint32_t>(Entries.size() * Traits::ENTRY_SIZE);
+        stream.write(reinterpret_cast<const char*>(&dwBlockSize), sizeof(dwBlockSize));
+
+        // Write TKEY entries
+        std::vector<char> entryBuffer(dwBlockSize);
+        char* entry = entryBuffer.data();
+        for (const auto& it : Entries)
+        {
+            *reinterpret_cast<uint32_t*>(entry) = it.second;
+            Traits::WriteKey(entry, it.first);
+            entry += Traits::ENTRY_SIZE;
+        }
+        stream.write(entryBuffer.data(), entryBuffer.size());
+    }
+
+    {
+        const char		header[] = { 'T', 'D', 'A', 'T' };
+        stream.write(header, sizeof(header));
+        const uint32_t	dwBlockSize = static_cast<uint32_t>(FormattedContent.size());
+        stream.write(reinterpret_cast<const char*>(&dwBlockSize), sizeof(dwBlockSize));
+
+        stream.write(FormattedContent.data(), FormattedContent.size());
+    }
+}
+
+template class GXTTable<GXTTraits::VC>;
+template class GXTTable<GXTTraits::SA>;
+template class GXTTable<GXTTraits::SA16Bit>;
+
+std::unique_ptr<GXTTableBase> GXTTableBase::InstantiateGXTTable(GXTEnum::eGXTVersion version)
+{
+    std::unique_ptr<GXTTableBase> ptr;
+    switch (version)
+    {
+    case GXTEnum::eGXTVersion::GXT_VC:
+        ptr = std::make_unique<VC::GXTTable>();
+        break;
+    case GXTEnum::eGXTVersion::GXT_SA:
+    case GXTEnum::eGXTVersion::GXT_SA_MOBILE:
+        ptr = std::make_unique<SA::GXTTable>();
+        break;
+    case GXTEnum::eGXTVersion::GXT_SA_16BIT:
+        ptr = std::make_unique<SA::GXTTable16Bit>();
+        break;
+    default:
+        throw std::runtime_error("Trying to instantiate an unsupported GXT table version " + std::to_string(version) + "!");
+        break;
+    }
+
+    return ptr;
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+#include "enum.h"
+#include "fixed_name.h"
+#include "flat_hash_map.h"
+
+#include <string>
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <fstream>
+#include <functional>
+#include <string_view>
+
+class GXTTableBase
+{
+public:
+    // Gets the name (or 0xHASH) and the raw TDAT bytes without the terminator of an entry
+    typedef std::function<void(const std::string& entryName, std::string_view content)>	EntryVisitor;
+
+    virtual ~GXTTableBase()
+    {}
+
+public:
+    // Entry texts are raw TDAT bytes without the terminator, in the character size of the table
+    virtual bool	ReplaceEntries(const NameEntryMap& entryMap) = 0;
+    virtual bool	ReplaceEntries(const HashEntryMap& entryMap) = 0;
+    // Makes the entries of the map the only entries of the table, their texts are laid out in TDAT in key order
+    virtual bool	SetEntries(const NameEntryMap& entryMap) = 0;
+    virtual bool	SetEntries(const HashEntryMap& entryMap) = 0;
+    virtual bool	UsesHashForEntryName() const = 0;
+    virtual size_t	GetCharacterSize() const = 0;
+    virtual size_t	GetNumEntries() const = 0;
+    virtual size_t	GetFormattedContentSize() const = 0;
+    virtual size_t	GetTKEYBlockSize() const = 0;
+    // Size FormattedContent would have after ReplaceEntries(entryMap), computed without building it
+    virtual size_t	GetReplacedFormattedContentSize(const NameEntryMap& entryMap) const = 0;
+    virtual size_t	GetReplacedFormattedContentSize(const HashEntryMap& entryMap) const = 0;
+    virtual size_t	ReadTKEYAndTDATBlock(std::istream& inputStream, const uint32_t offset) = 0;
+    virtual void	WriteTKEYAndTDATBlock(std::ostream& stream) const = 0;
+    virtual size_t	GetTKEYAndTDATBlockSize() const = 0;
+    // Copies the raw TDAT bytes of the entry (without the terminator) into content
+    virtual bool	FindEntryContent(const uint32_t crc32EntryHash, std::string& content) const = 0;
+    // Hash-keyed tables look up the hash of the name
+    virtual bool	FindEntryContent(const FixedName8& entryName, std::string& content) const = 0;
+    // Returns the names (or 0xHASH) and TDAT sizes including the terminator of the count largest entry texts, largest first
+    virtual std::vector<std::pair<std::string, size_t>>	GetLargestEntries(size_t count) const = 0;
+    // Visits every entry in key order
+    virtual void	ForEachEntry(const EntryVisitor& visitor) const = 0;
+    virtual std::unique_ptr<GXTTableBase>	Clone() const = 0;
+
+    static std::unique_ptr<GXTTableBase> InstantiateGXTTable(GXTEnum::eGXTVersion version);
+
+    void SetReplaceStrategy(GXTEnum::eReplaceStrategy strategy)
+    {
+        _replaceStrategy = strategy;
+    }
+
+    // Number of chunks TDAT is rebuilt in, 0 picks it from the cores and the table size and 1 rebuilds it serially
+    void SetRebuildChunkCount(size_t chunkCount)
+    {
+        _rebuildChunkCount = chunkCount;
+    }
+
+protected:
+    GXTEnum::eReplaceStrategy	_replaceStrategy = GXTEnum::eReplaceStrategy::ReplaceAuto;
+    size_t						_rebuildChunkCount = 0;
+};
+
+// Per-version layout of TKEY entries and TDAT characters. GXTTable<Traits> is compiled once per traits type,
+// so the loops over entries and characters don't go through virtual calls.
+namespace GXTTraits
+{
+    struct VC
+    {
+        typedef uint16_t		character_t;
+        typedef FixedName8		key_t;
+
+        static constexpr bool	USES_HASH_FOR_ENTRY_NAME = false;
+        static constexpr size_t	ENTRY_SIZE = sizeof(uint32_t) + FixedName8::SIZE;
+
+        static key_t ReadKey(const char* entry)
+        {
+            return FixedName8::Read(entry + sizeof(uint32_t));
+        }
+        static void WriteKey(char* entry, const key_t& key)
+        {
+            key.Write(entry + sizeof(uint32_t));
+        }
+    };
+
+    struct SA
+    {
+        typedef uint8_t			character_t;
+        typedef uint32_t		key_t;
+
+        static constexpr bool	USES_HASH_FOR_ENTRY_NAME = true;
+        static constexpr size_t	ENTRY_SIZE = sizeof(uint32_t) + sizeof(uint32_t);
+
+        static key_t ReadKey(const char* entry)
+        {
+            return *reinterpret_cast<const uint32_t*>(entry + sizeof(uint32_t));
+        }
+        static void WriteKey(char* entry, const key_t& key)
+        {
+            *reinterpret_cast<uint32_t*>(entry + sizeof(uint32_t)) = key;
+        }
+    };
+
+    // SA GXT files with the 0x100004 header
+    struct SA16Bit : SA
+    {
+        typedef uint16_t		character_t;
+    };
+};
+
+template<typename Traits>
+class GXTTable : public GXTTableBase
+{
+public:
+    typedef typename Traits::character_t	character_t;
+    typedef typename Traits::key_t			key_t;
+
+    virtual std::unique_ptr<GXTTableBase> Clone() const override
+    {
+        return std::make_unique<GXTTable>(*this);
+    }
+
+    virtual bool UsesHashForEntryName() const override
+    {
+        return Traits::USES_HASH_FOR_ENTRY_NAME;
+    }
+
+    virtual size_t GetCharacterSize() const override
+    {
+        return sizeof(character_t);
+    }
+
+    virtual size_t GetNumEntries() const override
+    {
+        return Entries.size();
+    }
+
+    virtual size_t GetFormattedContentSize() const override
+    {
+        return FormattedContent.size();
+    }
+
+    virtual size_t GetTKEYBlockSize() const override
+    {
+        return Entries.size() * Traits::ENTRY_SIZE;
+    }
+
+    virtual size_t GetTKEYAndTDATBlockSize() const override
+    {
+        return 16 + GetTKEYBlockSize() + FormattedContent.size();
+    }
+
+    virtual bool	ReplaceEntries(const NameEntryMap& entryMap) override;
+    virtual bool	ReplaceEntries(const HashEntryMap& entryMap) override;
+    virtual bool	SetEntries(const NameEntryMap& entryMap) override;
+    virtual bool	SetEntries(const HashEntryMap& entryMap) override;
+    virtual size_t	GetReplacedFormattedContentSize(const NameEntryMap& entryMap) const override;
+    virtual size_t	GetReplacedFormattedContentSize(const HashEntryMap& entryMap) const override;
+    virtual size_t	ReadTKEYAndTDATBlock(std::istream& inputStream, const uint32_t offset) override;
+    virtual void	WriteTKEYAndTDATBlock(std::ostream& stream) const override;
+    virtual bool	FindEntryContent(const uint32_t crc32EntryHash, std::string& content) const override;
+    virtual bool	FindEntryContent(const FixedName8& entryName, std::string& content) const override;
+    virtual std::vector<std::pair<std::string, size_t>>	GetLargestEntries(size_t count) const override;
+    virtual void	ForEachEntry(const EntryVisitor& visitor) const override;
+
+private:
+    // An entry in the order its text is written to TDAT
+    struct ContentEntry
+    {
+        uint32_t			originalOffset;
+        // Points into Entries
+        uint32_t*			newOffset;
+        // nullptr keeps the original text
+        const std::string*	replacement;
+        // The earlier entry that keeps the same original text, this one points to its copy instead of writing another
+        const ContentEntry*	sharedText = nullptr;
+    };
+
+    // Smaller tables are probed. Below this size BM_ReplaceEntries can't tell the strategies apart, from here on the
+    // merge is up to twice as fast when at most a tenth of the entries is replaced and as fast as probing above that.
+    static constexpr size_t	SORT_MERGE_MIN_ENTRIES = 1024;
+    // TDAT is rebuilt on several threads once every thread gets at least this many entries
+    static constexpr size_t	PARALLEL_REBUILD_MIN_CHUNK_ENTRIES = 16384;
+
+    template<typename Map>
+    bool	ReplaceEntriesImpl(const Map& entryMap);
+    template<typename Map>
+    void	SetEntriesImpl(const Map& entryMap);
+    template<typename Map>
+    size_t	GetReplacedFormattedContentSizeImpl(const Map& entryMap) const;
+    // Both return the entries sorted by their original offset, entries sharing an offset in key order
+    template<typename Map>
+    void	CollectByHashProbe(const Map& entryMap, std::vector<ContentEntry>& contentEntries);
+    template<typename Map>
+    void	CollectBySortMerge(const Map& entryMap, std::vector<ContentEntry>& contentEntries);
+    bool	UsesSortMerge() const;
+    // Drops replacements equal to the original text and links entries that keep a text another entry keeps too,
+    // so texts the entries of a table shared stay shared
+    void	ShareUnchangedTexts(std::vector<ContentEntry>& contentEntries) const;
+    bool	IsOriginalText(uint32_t offset, const std::string& text) const;
+    void	RebuildContent(const std::vector<ContentEntry>& contentEntries);
+    void	RebuildContentInParallel(const std::vector<ContentEntry>& contentEntries, size_t chunkCount);
+    // Returns the byte offset of the terminator of the text starting at offset
+    size_t	FindTerminator(size_t offset) const;
+    bool	CopyContent(uint32_t offset, std::string& content) const;
+
+    // Byte offsets into FormattedContent
+    std::map<key_t, uint32_t>	Entries;
+    // Raw TDAT bytes
+    std::string					FormattedContent;
+};
+
+namespace VC
+{
+    typedef ::GXTTable<GXTTraits::VC> GXTTable;
+};
+
+namespace SA
+{
+    typedef ::GXTTable<GXTTraits::SA> GXTTable;
+    typedef ::GXTTable<GXTTraits::SA16Bit> GXTTable16Bit;
+};
@@ -2,24 +2,19 @@
 #include "utf8.h"
 
 #include "utility.h"
+#include "build_cache.h"
+#include "build_stats.h"
+#include "platform.h"
 
 #include <fstream>
 #include <iostream>
 #include <forward_list>
-#include <Shlwapi.h>
 #include <ctime>
 #include <sstream>
 #include <array>
 #include <vector>
 #include <unordered_map>
 
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-
-#ifndef UNICODE
-#error GXT Builder must be compiled with Unicode character set
-#endif
-
 #ifdef _DEBUG
 #define DEBUG_COUT(str) do { std::cout << str; } while( false )
 #else
@@ -113,329 +108,125 @@ uint32_t crc32Continue(uint32_t hash, const char* Str)
     return hash;
 }
 
-GXTTableCollection::GXTTableCollection(std::string& tableName, uint32_t absoluteMainTableOffset, GXTEnum::eGXTVersion fileVersion)
+GXTTableCollection::GXTTableCollection(const FixedName8& tableName, uint32_t absoluteMainTableOffset, GXTEnum::eGXTVersion fileVersion)
     :_mainTable(std::move(GXTTableBlockInfo(tableName, absoluteMainTableOffset, fileVersion))), _fileVersion(fileVersion)
 {
 }
 
-void GXTTableCollection::AddNewMissionTable(std::string& tableName, uint32_t absoluteTableOffset)
+void GXTTableCollection::AddNewMissionTable(const FixedName8& tableName, uint32_t absoluteTableOffset)
 {
-    auto tableInfo = GXTTableBlockInfo(tableName, absoluteTableOffset, _fileVersion);
     _missionTable[tableName] = std::move(std::unique_ptr<GXTTableBlockInfo>(new GXTTableBlockInfo(tableName, absoluteTableOffset, _fileVersion)));
 }
 
-namespace VC
-{
-    bool GXTTable::InsertEntry(const std::string& entryName, uint32_t offset)
-    {
-        return Entries.emplace(entryName, static_cast<uint32_t>(offset * sizeof(character_t))).second != false;
-    }
-
-    void GXTTable::WriteOutEntries(std::ostream& stream)
-    {
-        for (auto& it : Entries)
-        {
-            // Pad string to 8 bytes
-            char buf[GXT_ENTRY_NAME_LEN];
-            StringCchCopyNExA(buf, _countof(buf), it.first.c_str(), GXT_ENTRY_NAME_LEN, nullptr, nullptr, STRSAFE_FILL_BEHIND_NULL);
-
-            stream.write(reinterpret_cast<const char*>(&it.second), sizeof(it.second));
-            stream.write(buf, GXT_ENTRY_NAME_LEN);
-        }
-    }
-
-    void GXTTable::WriteOutContent(std::ostream& stream)
-    {
-        stream.write(reinterpret_cast<const char*>(FormattedContent.c_str()), FormattedContent.size() * sizeof(character_t));
-    }
-
-    bool GXTTable::ReplaceEntries(const std::unordered_map<std::string, std::wstring>& entryMap)
-    {
-        if (entryMap.size() == 0)
-        {
-            return false;
-        }
-
-        using offset = uint32_t;
-        using entryName = std::string;
-
-        std::vector<std::pair<offset, entryName>> tempPairs;
-        tempPairs.reserve(Entries.size());
-
-        for (auto entryPair : Entries)
-        {
-            tempPairs.push_back(std::make_pair(entryPair.second, entryPair.first));
-        }
-
-        std::sort(tempPairs.begin(), tempPairs.end());
-
-        const auto originalContentStrings = StringExtension::SplitWString(FormattedContent, '0');
-
-        uint32_t index = 0;
-        std::wstring newFormattedStr;
-        newFormattedStr.reserve(FormattedContent.size());
-        for (auto pair : tempPairs)
-        {
-            auto itr = entryMap.find(pair.second);
-            if (itr != entryMap.end())
-            {
-                Entries[pair.second] = static_cast<uint32_t>(newFormattedStr.size() * sizeof(wchar_t));
-
-                auto contentStr = itr->second;
-                contentStr += '0';
-                newFormattedStr += contentStr;
-            }
-            else
-            {
-                Entries[pair.second] = static_cast<uint32_t>(newFormattedStr.size());
-
-                auto contentStr = originalContentStrings.at(index);
-                contentStr += '0';
-                newFormattedStr += contentStr;
-            }
-
-            index++;
-        }
-        FormattedContent = newFormattedStr;
-
-        return true;
-    }
-
-    void GXTTable::ReadEntireContent(std::ifstream& inputStream, const uint32_t offset, const size_t size)
-    {
-        std::vector<uint16_t> buffer;
-        buffer.resize(size / sizeof(uint16_t));
-
-        inputStream.seekg(offset, std::ios_base::beg);
-        inputStream.read(reinterpret_cast<char *>(buffer.data()), size);
-
-        FormattedContent = std::wstring{ buffer.begin(), buffer.end() };
-    }
-
-    void GXTTable::PushFormattedChar(int character)
-    {
-        FormattedContent.push_back(static_cast<character_t>(character));
-    }
-};
-
-namespace SA
+std::unique_ptr<GXTTableCollection> GXTTableCollection::Clone() const
 {
-    bool GXTTable::InsertEntry(const std::string& entryName, uint32_t offset)
+    auto copyTable = [](const GXTTableBlockInfo& source, GXTTableBlockInfo& target)
     {
-        uint32_t entryHash = crc32FromUpcaseString(entryName.c_str());
-        return Entries.emplace(entryHash, offset).second != false;
-    }
-    bool GXTTable::InsertEntry(const uint32_t crc32EntryHash, uint32_t offset)
+        target._GXTTable = source._GXTTable->Clone();
+        target._sourceDigest = source._sourceDigest;
+        target._splicedBlock = source._splicedBlock;
+    };
+
+    auto tableCollection = std::make_unique<GXTTableCollection>(_mainTable._tableName, _mainTable._absoluteOffset, _fileVersion);
+    copyTable(_mainTable, tableCollection->_mainTable);
+    for (const auto& missionTable : _missionTable)
     {
-        return Entries.emplace(crc32EntryHash, offset).second != false;
+        tableCollection->AddNewMissionTable(missionTable.first, missionTable.second->_absoluteOffset);
+        copyTable(*missionTable.second, *tableCollection->_missionTable[missionTable.first]);
     }
+    return tableCollection;
+}
 
-    bool GXTTable::ReplaceEntries(const std::unordered_map<uint32_t, std::string>& entryMap)
-    {
-        if (entryMap.size() == 0)
-        {
-            return false;
-        }
-
-        using hash = uint32_t;
-        using offset = uint32_t;
-
-        std::vector<std::pair<offset, hash>> tempPairs;
-        tempPairs.reserve(Entries.size());
-
-        for (auto entryPair : Entries)
-        {
-            tempPairs.push_back(std::make_pair(entryPair.second, entryPair.first));
-        }
-
-        std::sort(tempPairs.begin(), tempPairs.end());
-
-        const auto originalContentStrings = StringExtension::SplitString(FormattedContent, '\0', true);
-
-        uint32_t index = 0;
-        std::string newFormattedStr;
-        newFormattedStr.reserve(FormattedContent.size());
-        for (auto pair : tempPairs)
-        {
-            auto itr = entryMap.find(pair.second);
-            if (itr != entryMap.end())
-            {
-                Entries[pair.second] = static_cast<uint32_t>(newFormattedStr.size());
-
-                auto contentStr = itr->second;
-                contentStr += '\0';
-
-                newFormattedStr += contentStr;
-            }
-            else
-            {
-                Entries[pair.second] = static_cast<uint32_t>(newFormattedStr.size());
-                auto contentStr = originalContentStrings[index];
-                contentStr += '\0';
-
-                newFormattedStr += contentStr;
-            }
-            index++;
-        }
-        FormattedContent = newFormattedStr;
-
-        return true;
-    }
-
-    void GXTTable::WriteOutEntries(std::ostream& stream)
-    {
-        for (auto& it : Entries)
-        {
-            stream.write(reinterpret_cast<const char*>(&it.second), sizeof(it.second));
-            stream.write(reinterpret_cast<const char*>(&it.first), sizeof(it.first));
-        }
-    }
-
-    void GXTTable::WriteOutContent(std::ostream& stream)
-    {
-        stream.write(reinterpret_cast<const char*>(FormattedContent.c_str()), FormattedContent.size() * sizeof(character_t));
-    }
-
-    void GXTTable::ReadEntireContent(std::ifstream& inputStream, const uint32_t offset, const size_t size)
-    {
-        std::vector<char> buffer;
-        buffer.resize(size);
-
-        inputStream.seekg(offset, std::ios_base::beg);
-        inputStream.read(buffer.data(), size);
-
-        FormattedContent = std::move(std::string{ buffer.begin(), buffer.end() });
-    }
-
-    void GXTTable::PushFormattedChar(int character)
-    {
-        FormattedContent.push_back(static_cast<character_t>(character));
-    }
-};
-
-std::unique_ptr<GXTTableBase> GXTTableBase::InstantiateGXTTable(GXTEnum::eGXTVersion version)
+GXTTableBlockInfo* GXTTableCollection::FindTable(const FixedName8& tableName)
 {
-    std::unique_ptr<GXTTableBase> ptr;
-    switch (version)
+    if (_mainTable._tableName == tableName)
     {
-    case GXTEnum::eGXTVersion::GXT_VC:
-        ptr = std::make_unique<VC::GXTTable>();
-        break;
-    case GXTEnum::eGXTVersion::GXT_SA:
-        ptr = std::make_unique<SA::GXTTable>();
-        break;
-    default:
-        throw std::runtime_error(std::string("Trying to instantiate an unsupported GXT table version " + version) + "!");
-        break;
+        return &_mainTable;
     }
 
-    return ptr;
+    auto itr = _missionTable.find(tableName);
+    return itr != _missionTable.end() ? itr->second.get() : nullptr;
 }
 
-static std::pair<std::string, uint32_t> ReadTableBlock(std::ifstream& inputStream, const uint32_t offset)
+static std::pair<FixedName8, uint32_t> ReadTableBlock(std::ifstream& inputStream, const uint32_t offset)
 {
-    constexpr uint32_t TABLE_NAME_SIZE = 8;
     constexpr uint32_t OFFSET_STORAGE_SIZE = 4;
 
-    static std::string tableName(TABLE_NAME_SIZE, NULL);
-    static std::array<char, OFFSET_STORAGE_SIZE> offsetBuf;
+    std::array<char, FixedName8::SIZE> tableNameBuf;
+    std::array<char, OFFSET_STORAGE_SIZE> offsetBuf;
 
     inputStream.seekg(offset, std::ios_base::beg);
 
-    inputStream.read(&tableName[0], TABLE_NAME_SIZE);
-    inputStream.seekg(TABLE_NAME_SIZE, std::ios_base::cur);
-
+    inputStream.read(tableNameBuf.data(), FixedName8::SIZE);
     inputStream.read(offsetBuf.data(), OFFSET_STORAGE_SIZE);
     const uint32_t tableOffset = *(uint32_t*)offsetBuf.data();
 
-    return std::make_pair(tableName, tableOffset);
+    return std::make_pair(FixedName8::Read(tableNameBuf.data()), tableOffset);
 }
 
-size_t GXTTableBase::ReadTKEYAndTDATBlock(std::ifstream& inputStream, const uint32_t offset)
+static std::string ReadRawTKEYAndTDATBlock(std::ifstream& inputStream, const uint32_t offset)
 {
     constexpr uint32_t HEADER_SIZE = 4;
     constexpr uint32_t BLOCK_SIZE_STORAGE_SIZE = 4;
 
-    static std::array<char, HEADER_SIZE> headerBuf;
-    static const std::array<const char, HEADER_SIZE> HEADER_TKEY = { 'T', 'K', 'E', 'Y' };
-    static std::array<char, BLOCK_SIZE_STORAGE_SIZE> sizeBuf;
-
-    const bool usesHashForEntryName = UsesHashForEntryName();
-    const size_t	ONE_ENTRY_SIZE = GetEntrySize();
+    uint32_t TKEYBlockSize = 0;
+    uint32_t TDATBlockSize = 0;
 
-    inputStream.seekg(offset, std::ios_base::beg);
-
-    DEBUG_WCOUT(L"TKEY Block Offset" << inputStream.tellg() << "\n");
-    inputStream.read(headerBuf.data(), HEADER_SIZE);
+    inputStream.seekg(offset + HEADER_SIZE, std::ios_base::beg);
+    inputStream.read(reinterpret_cast<char *>(&TKEYBlockSize), BLOCK_SIZE_STORAGE_SIZE);
+    inputStream.seekg(offset + HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE + TKEYBlockSize + HEADER_SIZE, std::ios_base::beg);
+    inputStream.read(reinterpret_cast<char *>(&TDATBlockSize), BLOCK_SIZE_STORAGE_SIZE);
 
-    if (!std::equal(headerBuf.cbegin(), headerBuf.cend(), HEADER_TKEY.cbegin()))
+    if (!inputStream)
     {
-        throw std::runtime_error("The TKEY header wasn't found!");
+        throw std::runtime_error("The GXT file is corrupted! Offset: " + std::to_string(offset));
     }
 
-    inputStream.read(sizeBuf.data(), BLOCK_SIZE_STORAGE_SIZE);
-    const uint32_t	TKEYBlockSize = *(uint32_t*)sizeBuf.data();
+    std::string rawBlock(TKEYBlockSize + TDATBlockSize + (HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE) * 2, '\0');
+    inputStream.seekg(offset, std::ios_base::beg);
+    inputStream.read(&rawBlock[0], rawBlock.size());
 
-    uint32_t entryOffsetBuf;
-    uint32_t entryHashBuf;
-    std::string entryBuf(8, NULL);
+    return rawBlock;
+}
 
-    DEBUG_WCOUT(L"TKEY Block Offset" << inputStream.tellg() << "\n");
+// Reads the TKEY and TDAT block of the table, or splices the block from the build cache if the table doesn't need rebuilding
+static size_t ReadTableContent(std::ifstream& inputStream, const uint32_t offset, GXTTableBlockInfo& tableInfo, BuildCache* buildCache)
+{
+    GXT_STATS_TABLE(tableInfo._tableName.ToString());
 
-    for (size_t i = 0; i < TKEYBlockSize; i += ONE_ENTRY_SIZE)
+    if (buildCache != nullptr)
     {
-        if (usesHashForEntryName)
-        {
-            inputStream.read(reinterpret_cast<char *>(&entryOffsetBuf), 4);
-            const uint32_t entryOffset = entryOffsetBuf;
-
-            inputStream.read(reinterpret_cast<char *>(&entryHashBuf), 4);
-            const uint32_t entryHash = entryHashBuf;
+        std::string rawBlock = ReadRawTKEYAndTDATBlock(inputStream, offset);
+        const size_t rawBlockSize = rawBlock.size();
 
-            InsertEntry(entryHash, entryOffset);
-        }
-        else
+        tableInfo._sourceDigest = Digest::Compute(rawBlock);
+        if (buildCache->FindReusableBlock(tableInfo._tableName, tableInfo._sourceDigest, rawBlock))
         {
-            inputStream.read(reinterpret_cast<char *>(&entryOffsetBuf), 4);
-            const uint32_t entryOffset = entryOffsetBuf;
-
-            inputStream.read(&entryBuf[0], 8);
-
-            InsertEntry(entryBuf, entryOffset);
+            tableInfo._splicedBlock = std::move(rawBlock);
+            GXT_STATS_ADD(CounterBytesRead, rawBlockSize);
+            return rawBlockSize;
         }
     }
 
-    static const std::array<const char, HEADER_SIZE> HEADER_TDAT = { 'T', 'D', 'A', 'T' };
-    inputStream.read(headerBuf.data(), HEADER_SIZE);
-
-    if (!std::equal(headerBuf.cbegin(), headerBuf.cend(), HEADER_TDAT.cbegin()))
-    {
-        std::string errorStr = std::string("The TDAT header wasn't found! Offset: ");
-        errorStr.append(std::to_string(inputStream.tellg()));
-        errorStr.append("\n");
-        throw std::runtime_error(errorStr);
-        return 0;
-    }
-
-    inputStream.read(sizeBuf.data(), BLOCK_SIZE_STORAGE_SIZE);
-    const uint32_t	TDATBlockSize = *(uint32_t*)sizeBuf.data();
-
-    const uint32_t	totalSize = TKEYBlockSize + TDATBlockSize + (HEADER_SIZE + BLOCK_SIZE_STORAGE_SIZE) * 2;
-
-    ReadEntireContent(inputStream, static_cast<uint32_t>(inputStream.tellg()), TDATBlockSize);
-    DEBUG_WCOUT(L"Table Entry count " << GetNumEntries() << L"\n");
-
-    return totalSize;
+    const size_t blockSize = tableInfo._GXTTable->ReadTKEYAndTDATBlock(inputStream, offset);
+    GXT_STATS_ADD(CounterEntriesRead, tableInfo._GXTTable->GetNumEntries());
+    GXT_STATS_ADD(CounterBytesRead, blockSize);
+    return blockSize;
 }
 
-static std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileName, const GXTEnum::eGXTVersion fileVersion)
+std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileName, const GXTEnum::eGXTVersion fileVersion, BuildCache* buildCache)
 {
-    std::ifstream	inputFile(fileName, std::ifstream::binary);
+    GXT_STATS_TIMER(PhaseReadGXT);
+    std::ifstream	inputFile(Platform::ToPath(fileName), std::ifstream::binary);
 
     if (inputFile.is_open())
     {
+        GXT_STATS_ADD(CounterFilesOpened, 1);
+
         uint32_t		dwCurrentOffset = 0;
         uint32_t		headerValue = 0;
+        // The character size of SA tables comes from the header
+        GXTEnum::eGXTVersion	tableVersion = fileVersion;
 
         constexpr uint32_t HEADER_SIZE = 4;
         constexpr uint32_t BLOCK_SIZE_STORAGE_SIZE = 4;
@@ -443,7 +234,7 @@ static std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileN
         std::array<char, BLOCK_SIZE_STORAGE_SIZE> sizeBuf;
 
 #pragma region "Header"
-        if (fileVersion == GXTEnum::eGXTVersion::GXT_SA || fileVersion == GXTEnum::eGXTVersion::GXT_SA_MOBILE)
+        if (fileVersion != GXTEnum::eGXTVersion::GXT_VC)
         {
             inputFile.read(headerBuf.data(), HEADER_SIZE);
 
@@ -453,6 +244,14 @@ static std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileN
             {
                 throw std::runtime_error("Incorrect GXT version!");
             }
+            if (headerValue == 0x100004)
+            {
+                tableVersion = GXTEnum::eGXTVersion::GXT_SA_16BIT;
+            }
+            else if (fileVersion == GXTEnum::eGXTVersion::GXT_SA_16BIT)
+            {
+                throw std::runtime_error("The GXT file doesn't have 16-bit texts!");
+            }
 
             dwCurrentOffset += HEADER_SIZE;
             inputFile.seekg(dwCurrentOffset, std::ios_base::beg);
@@ -483,7 +282,7 @@ static std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileN
         inputFile.seekg(dwCurrentOffset, std::ios_base::beg);
 
         auto mainBlocktableTuple = ReadTableBlock(inputFile, static_cast<uint32_t>(inputFile.tellg()));
-        std::string mainTableName = std::get<std::string>(mainBlocktableTuple);
+        const FixedName8 mainTableName = std::get<FixedName8>(mainBlocktableTuple);
         uint32_t mainTableOffset = std::get<uint32_t>(mainBlocktableTuple);
 
         const uint32_t	ONE_TABLE_BLOCK_SIZE = 12;
@@ -491,12 +290,12 @@ static std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileN
         dwCurrentOffset += ONE_TABLE_BLOCK_SIZE;
         inputFile.seekg(dwCurrentOffset, std::ios_base::beg);
 
-        auto tableCollection = std::make_unique<GXTTableCollection>(mainTableName, mainTableOffset, fileVersion);
+        auto tableCollection = std::make_unique<GXTTableCollection>(mainTableName, mainTableOffset, tableVersion);
 
         for (uint32_t i = 12; i < dwBlockSize; i += ONE_TABLE_BLOCK_SIZE)
         {
             auto tableTuple = ReadTableBlock(inputFile, static_cast<uint32_t>(inputFile.tellg()));
-            std::string tableName = std::get<std::string>(tableTuple);
+            const FixedName8 tableName = std::get<FixedName8>(tableTuple);
             uint32_t offset = std::get<uint32_t>(tableTuple);
 
             tableCollection->AddNewMissionTable(tableName, offset);
@@ -504,31 +303,28 @@ static std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileN
             dwCurrentOffset += ONE_TABLE_BLOCK_SIZE;
             inputFile.seekg(dwCurrentOffset, std::ios_base::beg);
         }
+        GXT_STATS_ADD(CounterBytesRead, dwCurrentOffset);
 #pragma endregion
 
         //#pragma region "Read TKEY and TDAT sections"
-        auto& mainGXTTable = tableCollection->GetMainTable()._GXTTable;
-
-        dwCurrentOffset += static_cast<uint32_t>(mainGXTTable->ReadTKEYAndTDATBlock(inputFile, dwCurrentOffset));
+        dwCurrentOffset += static_cast<uint32_t>(ReadTableContent(inputFile, dwCurrentOffset, tableCollection->GetMainTable(), buildCache));
         // Align to 4 bytes
         dwCurrentOffset = (dwCurrentOffset + 4 - 1) & ~(4 - 1);
         inputFile.seekg(dwCurrentOffset, std::ios_base::beg);
 
-        DEBUG_WCOUT(L"Main table entry count " << mainGXTTable->GetNumEntries() << L"\n");
-        DEBUG_WCOUT(L"Main Table content size " << mainGXTTable->GetFormattedContentSize() << L"\n");
+        DEBUG_WCOUT(L"Main table entry count " << tableCollection->GetMainTable()._GXTTable->GetNumEntries() << L"\n");
+        DEBUG_WCOUT(L"Main Table content size " << tableCollection->GetMainTable()._GXTTable->GetFormattedContentSize() << L"\n");
 
         auto& missionGXTTables = tableCollection->GetMissionTableMap();
 
         for (const auto& table : missionGXTTables)
         {
-            std::array<char, 8> tableNameBuf;
+            std::array<char, FixedName8::SIZE> tableNameBuf;
 
             inputFile.seekg(dwCurrentOffset, std::ios_base::beg);
-            inputFile.read(tableNameBuf.data(), 8);
+            inputFile.read(tableNameBuf.data(), FixedName8::SIZE);
 
-            auto& tableName = table.first;
-
-            if (!std::equal(tableNameBuf.cbegin(), tableNameBuf.cend(), tableName.cbegin()))
+            if (FixedName8::Read(tableNameBuf.data()) != table.first)
             {
                 std::string errorStr = std::string("The table name and TKEY header name does not equal! Offset: ");
                 errorStr.append(std::to_string(inputFile.tellg()));
@@ -538,19 +334,18 @@ static std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileN
 
             dwCurrentOffset += 8;
 
-            auto& missionGXTTable = table.second->_GXTTable;
-            dwCurrentOffset += static_cast<uint32_t>(missionGXTTable->ReadTKEYAndTDATBlock(inputFile, dwCurrentOffset));
+            dwCurrentOffset += static_cast<uint32_t>(ReadTableContent(inputFile, dwCurrentOffset, *table.second, buildCache));
 
             // Align to 4 bytes
             dwCurrentOffset = (dwCurrentOffset + 4 - 1) & ~(4 - 1);
 
-            auto debugTableName = table.first;
+            auto debugTableName = table.first.ToString();
             debugTableName.push_back(':');
 
             DEBUG_COUT(debugTableName);
-            DEBUG_WCOUT(L" table entry count " << missionGXTTable->GetNumEntries() << L"\n");
+            DEBUG_WCOUT(L" table entry count " << table.second->_GXTTable->GetNumEntries() << L"\n");
             DEBUG_COUT(debugTableName);
-            DEBUG_WCOUT(L" table content size " << missionGXTTable->GetFormattedContentSize() << L"\n");
+            DEBUG_WCOUT(L" table content size " << table.second->_GXTTable->GetFormattedContentSize() << L"\n");
         }
 
         DEBUG_WCOUT(L"Table counts " << 1 + missionGXTTables.size() << L"\n");
@@ -565,19 +360,69 @@ static std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileN
     }
 }
 
+std::vector<uint32_t> GXTTableCollection::ComputeTableOffsets(const std::vector<size_t>& blockSizes, uint32_t& fileSize) const
+{
+    std::vector<uint32_t> tableOffsets;
+    tableOffsets.reserve(blockSizes.size());
+
+    // Header, TABL header and one TABL entry per table
+    uint32_t currentOffset = _fileVersion != GXTEnum::eGXTVersion::GXT_VC ? 4 : 0;
+    currentOffset += 8 + static_cast<uint32_t>(blockSizes.size() * 12);
+
+    uint32_t endOffset = currentOffset;
+    for (size_t i = 0; i < blockSizes.size(); i++)
+    {
+        tableOffsets.push_back(currentOffset);
+
+        // Mission tables repeat their name before TKEY
+        endOffset = currentOffset + static_cast<uint32_t>((i > 0 ? 8 : 0) + blockSizes[i]);
+
+        // Align to 4 bytes
+        currentOffset = (endOffset + 4 - 1) & ~(4 - 1);
+    }
+
+    // The padding after the last table isn't written
+    fileSize = endOffset;
+    return tableOffsets;
+}
+
+std::vector<size_t> GXTTableCollection::GetBlockSizes()
+{
+    std::vector<size_t> blockSizes;
+    blockSizes.reserve(1 + _missionTable.size());
+    blockSizes.push_back(_mainTable.GetBlockSize());
+    for (auto& ite : _missionTable)
+    {
+        blockSizes.push_back(ite.second->GetBlockSize());
+    }
+    return blockSizes;
+}
+
+uint32_t GXTTableCollection::ComputeFileSize()
+{
+    uint32_t fileSize = 0;
+    ComputeTableOffsets(GetBlockSizes(), fileSize);
+    return fileSize;
+}
+
 bool GXTTableCollection::WriteGXTFile(const std::wstring& fileName)
 {
-    std::ofstream	outputFile(fileName, std::ofstream::binary);
+    GXT_STATS_TIMER(PhaseWriteGXT);
+    std::ofstream	outputFile(Platform::ToPath(fileName), std::ofstream::binary);
     if (outputFile.is_open())
     {
-        uint32_t		currentOffset = 0;
+        GXT_STATS_ADD(CounterFilesOpened, 1);
+
+        uint32_t		fileSize = 0;
+        const auto		tableOffsets = ComputeTableOffsets(GetBlockSizes(), fileSize);
 
         // Header
-        if (_fileVersion == GXTEnum::eGXTVersion::GXT_SA)
+        if (_fileVersion != GXTEnum::eGXTVersion::GXT_VC)
         {
-            const char		header[] = { 0x04, 0x00, 0x08, 0x00 };
+            // The second half of the header is the character size in bits
+            const char		characterBits = _fileVersion == GXTEnum::eGXTVersion::GXT_SA_16BIT ? 0x10 : 0x08;
+            const char		header[] = { 0x04, 0x00, characterBits, 0x00 };
             outputFile.write(header, sizeof(header));
-            currentOffset += 4;
         }
 
         // Write TABL section
@@ -588,49 +433,23 @@ bool GXTTableCollection::WriteGXTFile(const std::wstring& fileName)
             const uint32_t	dwBlockSize = static_cast<uint32_t>(12 + _missionTable.size() * 12);
             outputFile.write(reinterpret_cast<const char*>(&dwBlockSize), sizeof(dwBlockSize));
 
-            currentOffset += sizeof(header) + sizeof(dwBlockSize) + dwBlockSize;
-
-            {
-                outputFile.write(_mainTable._tableName.c_str(), 8);
-                outputFile.write(reinterpret_cast<const char*>(&currentOffset), sizeof(currentOffset));
-                currentOffset += static_cast<uint32_t>(16 + (_mainTable._GXTTable->GetNumEntries() * _mainTable._GXTTable->GetEntrySize()) + _mainTable._GXTTable->GetFormattedContentSize());
-
-                // Align to 4 bytes
-                currentOffset = (currentOffset + 4 - 1) & ~(4 - 1);
-            }
+            outputFile.write(_mainTable._tableName.ToBytes().data(), FixedName8::SIZE);
+            outputFile.write(reinterpret_cast<const char*>(&tableOffsets[0]), sizeof(uint32_t));
 
+            size_t tableIndex = 1;
             for (auto& ite : _missionTable)
             {
-                outputFile.write(ite.second->_tableName.c_str(), 8);
-                outputFile.write(reinterpret_cast<const char*>(&currentOffset), sizeof(currentOffset));
-                currentOffset += static_cast<uint32_t>(16 + 8 + (ite.second->_GXTTable->GetNumEntries() * ite.second->_GXTTable->GetEntrySize()) + ite.second->_GXTTable->GetFormattedContentSize());
-
-                // Align to 4 bytes
-                currentOffset = (currentOffset + 4 - 1) & ~(4 - 1);
+                outputFile.write(ite.second->_tableName.ToBytes().data(), FixedName8::SIZE);
+                outputFile.write(reinterpret_cast<const char*>(&tableOffsets[tableIndex++]), sizeof(uint32_t));
             }
         }
+        GXT_STATS_ADD(CounterBytesWritten, outputFile.tellp());
 
         // Write TKEY and TDAT sections
-
         {
-            {
-                const char		header[] = { 'T', 'K', 'E', 'Y' };
-                outputFile.write(header, sizeof(header));
-                const uint32_t	dwBlockSize = static_cast<uint32_t>(_mainTable._GXTTable->GetNumEntries() * _mainTable._GXTTable->GetEntrySize());
-                outputFile.write(reinterpret_cast<const char*>(&dwBlockSize), sizeof(dwBlockSize));
-
-                // Write TKEY entries
-                _mainTable._GXTTable->WriteOutEntries(outputFile);
-            }
-
-            {
-                const char		header[] = { 'T', 'D', 'A', 'T' };
-                outputFile.write(header, sizeof(header));
-                const uint32_t	dwBlockSize = static_cast<uint32_t>(_mainTable._GXTTable->GetFormattedContentSize());
-                outputFile.write(reinterpret_cast<const char*>(&dwBlockSize), sizeof(dwBlockSize));
-
-                _mainTable._GXTTable->WriteOutContent(outputFile);
-            }
+            GXT_STATS_TABLE(_mainTable._tableName.ToString());
+            GXT_STATS_ADD(CounterBytesWritten, _mainTable.GetBlockSize());
+            _mainTable.WriteOutBlock(outputFile);
 
             // Align to 4 bytes
             if (outputFile.tellp() % 4)
@@ -638,26 +457,11 @@ bool GXTTableCollection::WriteGXTFile(const std::wstring& fileName)
         }
         for (const auto& ite : _missionTable)
         {
-            outputFile.write(ite.second->_tableName.c_str(), 8);
+            GXT_STATS_TABLE(ite.second->_tableName.ToString());
+            GXT_STATS_ADD(CounterBytesWritten, FixedName8::SIZE + ite.second->GetBlockSize());
+            outputFile.write(ite.second->_tableName.ToBytes().data(), FixedName8::SIZE);
 
-            {
-                const char		header[] = { 'T', 'K', 'E', 'Y' };
-                outputFile.write(header, sizeof(header));
-                const uint32_t	dwBlockSize = static_cast<uint32_t>(ite.second->_GXTTable->GetNumEntries() * ite.second->_GXTTable->GetEntrySize());
-                outputFile.write(reinterpret_cast<const char*>(&dwBlockSize), sizeof(dwBlockSize));
-
-                // Write TKEY entries
-                ite.second->_GXTTable->WriteOutEntries(outputFile);
-            }
-
-            {
-                const char		header[] = { 'T', 'D', 'A', 'T' };
-                outputFile.write(header, sizeof(header));
-                const uint32_t	dwBlockSize = static_cast<uint32_t>(ite.second->_GXTTable->GetFormattedContentSize());
-                outputFile.write(reinterpret_cast<const char*>(&dwBlockSize), sizeof(dwBlockSize));
-
-                ite.second->_GXTTable->WriteOutContent(outputFile);
-            }
+            ite.second->WriteOutBlock(outputFile);
 
             // Align to 4 bytes
             if (outputFile.tellp() % 4)
@@ -674,217 +478,149 @@ bool GXTTableCollection::WriteGXTFile(const std::wstring& fileName)
     }
 }
 
-void GXTTableCollection::BulkReplaceText(std::wstring& textSourceDirectory, GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage, std::ofstream& logFile)
+static void ConvertEntryTexts(HashEntryMap& entryMap, const TextConverter& textConverter, size_t characterSize, BuildCache* buildCache)
 {
-    namespace fs = std::experimental::filesystem::v1;
-    constexpr auto directorySeparatorChar = L"\\";
-
-    std::optional<CharMapArray> charMap;
-    if (textConvertingMode == GXTEnum::eTextConvertingMode::UseCharacterMap)
+    if (buildCache == nullptr || textConverter.GetTextConvertingMode() == GXTEnum::eTextConvertingMode::UseUtf8OrUtf16)
     {
-        charMap = CharMap::ParseCharacterMap(L"charmap.txt");
+        textConverter.ConvertFromUtf8(entryMap, characterSize);
+        return;
     }
 
-    const std::wstring mainTableName = Encoding::AnsiStringToWString(_mainTable._tableName);
-    const std::wstring textDirectoryForMainTable(textSourceDirectory + directorySeparatorChar + mainTableName);
-
-    if (Directory::Exists(textDirectoryForMainTable))
+    // Only the entries that weren't converted in a previous build go through the encoder
+    HashEntryMap pendingEntries;
+    std::unordered_map<uint32_t, uint64_t> pendingEntryDigests;
+    for (auto& pair : entryMap)
     {
-        if (UsesHashForEntryName())
+        const uint64_t entryDigest = BuildCache::ComputeEntryDigest(pair.first, pair.second, characterSize);
+        const std::string* convertedText = buildCache->FindConvertedEntry(entryDigest);
+        if (convertedText != nullptr)
         {
-            auto entryMap = EntryLoader::LoadHashEntryTextsInDirectory(textDirectoryForMainTable, logFile);
-
-            switch (textConvertingMode)
-            {
-                case GXTEnum::eTextConvertingMode::UseCharacterMap:
-                {
-                    CharMap::ApplyCharacterMap(entryMap, charMap.value());
-                }
-                    break;
-                case GXTEnum::eTextConvertingMode::UseAnsi:
-                {
-                    Encoding::MapUtf8StringToAnsi(entryMap, ansiCodePage);
-                }
-                    break;
-                default:
-                    break;
-            }
-
-            _mainTable._GXTTable->ReplaceEntries(entryMap);
+            pair.second = *convertedText;
         }
         else
         {
-            //Not implemented
+            pendingEntries.emplace(pair.first, pair.second);
+            pendingEntryDigests.emplace(pair.first, entryDigest);
         }
     }
 
-    auto& missionGXTTables = GetMissionTableMap();
-    for (auto& missionTable : missionGXTTables)
+    textConverter.ConvertFromUtf8(pendingEntries, characterSize);
+
+    for (auto& pair : pendingEntries)
     {
-        const std::wstring missionTableName = Encoding::AnsiStringToWString(missionTable.second->_tableName);
-        const std::wstring textDirectoryForMissionTable(textSourceDirectory + directorySeparatorChar + missionTableName);
-        if (Directory::Exists(textDirectoryForMissionTable))
-        {
-            if (UsesHashForEntryName())
-            {
-                auto entryMap = EntryLoader::LoadHashEntryTextsInDirectory(textDirectoryForMissionTable, logFile);
-
-                switch (textConvertingMode)
-                {
-                    case GXTEnum::eTextConvertingMode::UseCharacterMap:
-                    {
-                        CharMap::ApplyCharacterMap(entryMap, charMap.value());
-                    }
-                        break;
-                    case GXTEnum::eTextConvertingMode::UseAnsi:
-                    {
-                        Encoding::MapUtf8StringToAnsi(entryMap, ansiCodePage);
-                    }
-                        break;
-                    default:
-                        break;
-                }
-
-                missionTable.second->_GXTTable->ReplaceEntries(entryMap);
-            }
-            else
-            {
-                //Not implemented
-            }
-        }
+        buildCache->StoreConvertedEntry(pendingEntryDigests[pair.first], pair.second);
+        entryMap[pair.first] = std::move(pair.second);
     }
 }
 
-const wchar_t* GetFormatName(GXTEnum::eGXTVersion version)
+// Loads the converted texts of the table from its text folder and passes the entry map (a HashEntryMap or a NameEntryMap)
+// to useEntryMap. Returns false if the table has no text folder.
+template<typename Action>
+static bool LoadTableTexts(const GXTTableBlockInfo& tableInfo, const std::wstring& textSourceDirectory, const TextConverter& textConverter, DiagnosticLog& log, BuildCache* buildCache, const Action& useEntryMap)
 {
-    switch (version)
+    const std::wstring tableName = Encoding::AnsiStringToWString(tableInfo._tableName.ToString());
+    const std::wstring textDirectoryForTable(textSourceDirectory + Platform::PATH_SEPARATOR + tableName);
+
+    if (!Directory::Exists(textDirectoryForTable))
     {
-    case GXTEnum::eGXTVersion::GXT_VC:
-        return L"GTA Vice City";
-    case GXTEnum::eGXTVersion::GXT_SA:
-        return L"GTA San Andreas";
+        return false;
     }
-    return L"Unsupported";
-}
 
-std::wstring GetFileNameNoExtension(std::wstring path)
-{
-    std::wstring::size_type namePos = path.find_last_of(L"/\\");
-    std::wstring::size_type extPos = path.find_last_of(L'.');
-    if (namePos == std::wstring::npos)
-        path = path.substr(0, extPos);
-    else
-        path = path.substr(namePos + 1, extPos);
-    return path;
-}
+    const GXTTableBase& table = *tableInfo._GXTTable;
+    if (table.UsesHashForEntryName())
+    {
+        auto entryMap = EntryLoader::LoadHashEntryTextsInDirectory(textDirectoryForTable, log);
 
-std::wstring GetFileExtension(std::wstring path)
-{
-    std::wstring::size_type extPos = path.find_last_of(L'.');
-    if (extPos != std::wstring::npos)
-        path = path.substr(extPos, path.length() - extPos);
+        ConvertEntryTexts(entryMap, textConverter, table.GetCharacterSize(), buildCache);
+
+        useEntryMap(entryMap);
+    }
     else
-        path = std::wstring();
-    return path;
+    {
+        auto entryMap = EntryLoader::LoadEntryTextsInDirectory(textDirectoryForTable, log);
+
+        textConverter.ConvertFromUtf8(entryMap, table.GetCharacterSize());
+
+        useEntryMap(entryMap);
+    }
+    return true;
 }
 
-static std::vector<std::wstring> MakeStringArgv(wchar_t* argv[])
+static void ReplaceTableTexts(GXTTableBlockInfo& tableInfo, const std::wstring& textSourceDirectory, const TextConverter& textConverter, DiagnosticLog& log, BuildCache* buildCache)
 {
-    std::vector<std::wstring> result;
-    while (*argv != nullptr)
+    GXT_STATS_TABLE(tableInfo._tableName.ToString());
+
+    if (tableInfo.IsSpliced())
     {
-        result.emplace_back(*argv++);
+        return;
     }
-    return result;
-}
 
-static const char* const helpText = "Usage:\tgxt_text_replacer.exe [GXT filename] [Text folder] [-usecharmap] [-ansitext] [-unicodetext] [-ansicodepage (value)]\n"
-"IMPORTANT: Currently, only SA GXT for non-remastered version is supported.\n"
-"\t-ansitext - Convert texts into ansi characters (the current default setting)\n"
-"\t-unicodetext - Convert texts into UTF-16 texts if GXT file content uses 16 bit char text, or doesn't convert if GXT file content uses 8 bit char text\n"
-"\t-ansicodepage - Specify ANSI code page for converting text into ANSI ones\n"
-"\t-usecharmap - Convert texts using character map (not recommended because non-ASCII characters are currently not supported)\n";
+    LoadTableTexts(tableInfo, textSourceDirectory, textConverter, log, buildCache, [&](const auto& entryMap)
+    {
+        GXT_STATS_TIMER(PhaseReplaceEntries);
+        tableInfo._GXTTable->ReplaceEntries(entryMap);
+    });
+}
 
-namespace 
+void GXTTableCollection::BulkReplaceText(std::wstring& textSourceDirectory, GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage, DiagnosticLog& log, BuildCache* buildCache)
 {
-    int AnsiCodePage = GetACP();
+    const TextConverter textConverter(textConvertingMode, ansiCodePage);
+    BulkReplaceText(textSourceDirectory, textConverter, log, buildCache);
 }
 
-int wmain(int argc, wchar_t* argv[])
+void GXTTableCollection::BulkReplaceText(const std::wstring& textSourceDirectory, const TextConverter& textConverter, DiagnosticLog& log, BuildCache* buildCache)
 {
-    std::ios_base::sync_with_stdio(false);
-    std::wcout << L"GXT Text Replacer v0.9\nMade by kagikn, Special thanks to Silent\n";
-
-    const std::vector<std::wstring> argvStr = MakeStringArgv(argv);
-
-    setlocale(LC_CTYPE, "");
+    ReplaceTableTexts(_mainTable, textSourceDirectory, textConverter, log, buildCache);
 
-    if (argc >= 3)
+    for (auto& missionTable : GetMissionTableMap())
     {
-        if (argvStr[1] == L"--help")
-        {
-            std::cout << helpText;
-            return 0;
-        }
-
-        // A map of GXT tables
-        std::wstring GXTName(argvStr[1]);
-        std::wstring TextDirectoryToReplace(argvStr[2]);
-        std::ofstream LogFile;
+        ReplaceTableTexts(*missionTable.second, textSourceDirectory, textConverter, log, buildCache);
+    }
 
-        // Parse commandline arguments
-        GXTEnum::eGXTVersion fileVersion = GXTEnum::eGXTVersion::GXT_SA;
-        GXTEnum::eTextConvertingMode textConvMode = GXTEnum::eTextConvertingMode::UseAnsi;
-        int ansiCodePage = GetACP();
+    // The diagnostics of all tables are written at once
+    log.Flush();
+}
 
-        int	firstStream = 2;
-        for (int i = 2; i < argc; ++i)
-        {
-            if (argvStr[i][0] == '-')
-            {
-                const std::wstring&	tmp = argvStr[i];
-                firstStream++;
-                if (tmp == L"-ansitext")
-                    textConvMode = GXTEnum::eTextConvertingMode::UseAnsi;
-                if (tmp == L"-usecharmap")
-                    textConvMode = GXTEnum::eTextConvertingMode::UseCharacterMap;
-                if (tmp == L"-unicodetext")
-                    textConvMode = GXTEnum::eTextConvertingMode::UseUtf8OrUtf16;
-
-                if (tmp == L"-ansicodepage" && i + 1 < argc)
-                {
-                    ansiCodePage = std::stoi(argvStr[i + 1]);
-                }
-            }
-            else
-                break;
-        }
+GXTFilePlan GXTTableCollection::PlanReplaceText(const std::wstring& textSourceDirectory, const TextConverter& textConverter, DiagnosticLog& log)
+{
+    GXTFilePlan plan;
 
-        if (GetFileExtension(GXTName).empty())
+    auto planTable = [&](const GXTTableBlockInfo& tableInfo)
+    {
+        const GXTTableBase& table = *tableInfo._GXTTable;
+
+        GXTTablePlan tablePlan;
+        tablePlan.tableName = tableInfo._tableName;
+        tablePlan.entryCount = table.GetNumEntries();
+        tablePlan.TKEYBlockSize = table.GetTKEYBlockSize();
+        tablePlan.TDATBlockSize = table.GetFormattedContentSize();
+        tablePlan.hasTexts = LoadTableTexts(tableInfo, textSourceDirectory, textConverter, log, nullptr, [&](const auto& entryMap)
         {
-            GXTName += L".gxt";
-        }
+            tablePlan.TDATBlockSize = table.GetReplacedFormattedContentSize(entryMap);
+        });
+        plan.tables.push_back(tablePlan);
+    };
 
-        try
-        {
-            auto gxt = ReadGXTFile(GXTName, fileVersion);
-            LogFile.open(GetFileNameNoExtension(GXTName) + L"_replace.log");
-            gxt->BulkReplaceText(TextDirectoryToReplace, textConvMode, ansiCodePage, LogFile);
-            gxt->WriteGXTFile(GXTName);
-        }
-        catch (std::exception& e)
-        {
-            std::cerr << "ERROR: " << e.what();
-            return 1;
-        }
+    planTable(_mainTable);
+    for (auto& missionTable : GetMissionTableMap())
+    {
+        planTable(*missionTable.second);
+    }
+    log.Flush();
 
-        return 0;
+    std::vector<size_t> blockSizes;
+    blockSizes.reserve(plan.tables.size());
+    for (const auto& tablePlan : plan.tables)
+    {
+        // TKEY and TDAT headers and block sizes
+        blockSizes.push_back(16 + tablePlan.TKEYBlockSize + tablePlan.TDATBlockSize);
     }
-    else
+
+    const auto tableOffsets = ComputeTableOffsets(blockSizes, plan.fileSize);
+    for (size_t i = 0; i < plan.tables.size(); i++)
     {
-        std::cout << helpText;
-        return 0;
+        plan.tables[i].tableOffset = tableOffsets[i];
     }
 
-    return 0;
-}
\ No newline at end of file
+    return plan;
+}
@@ -4,65 +4,40 @@
 #define __GXTBUILD_H
 
 #include "enum.h"
+#include "gxt_table.h"
+#include "fixed_name.h"
 #include "crc32keygen.h"
 
 #include <string>
 #include <map>
+#include <vector>
 #include <unordered_map>
 #include <memory>
-#include <strsafe.h>
-#include <intrin.h>
-
-class GXTTableBase
-{
-public:
-    std::wstring			szPath;
-    std::string				Content;
-
-    GXTTableBase(std::wstring szFilePath)
-        : szPath(std::move(szFilePath))
-    {}
-    GXTTableBase()
-    {}
-    virtual ~GXTTableBase()
-    {}
-
-public:
-    virtual bool	InsertEntry(const std::string& entryName, uint32_t offset) = 0;
-    virtual bool	InsertEntry(const uint32_t crc32EntryHash, uint32_t offset) = 0;
-    virtual bool	ReplaceEntries(const std::unordered_map<std::string, std::wstring>& entryMap) = 0;
-    virtual bool	ReplaceEntries(const std::unordered_map<uint32_t, std::string>& entryMap) = 0;
-    virtual bool	UsesHashForEntryName() = 0;
-    virtual size_t	GetNumEntries() = 0;
-    virtual size_t	GetFormattedContentSize() = 0;
-    virtual size_t	GetEntrySize() = 0;
-    virtual void	WriteOutEntries(std::ostream& stream) = 0;
-    virtual void	WriteOutContent(std::ostream& stream) = 0;
-    virtual size_t	ReadTKEYAndTDATBlock(std::ifstream& inputStream, const uint32_t offset);
-    virtual void	ReadEntireContent(std::ifstream& inputStream, const uint32_t offset, const size_t size) = 0;
-    virtual void	PushFormattedChar(int character) = 0;
-
-    static std::unique_ptr<GXTTableBase> InstantiateGXTTable(GXTEnum::eGXTVersion version);
-
-private:
-
-};
+#include <fstream>
 
+class BuildCache;
+class DiagnosticLog;
+class TextConverter;
 
 class GXTTableBlockInfo
 {
 public:
     uint32_t			_absoluteOffset = 0;
-    std::string			_tableName;
+    FixedName8			_tableName;
     std::unique_ptr<GXTTableBase>				_GXTTable;
 
-    GXTTableBlockInfo(std::string tableName, GXTEnum::eGXTVersion fileVersion)
+    // Digest of the TKEY and TDAT block as it was read (only computed when the build cache is enabled)
+    uint64_t			_sourceDigest = 0;
+    // Serialized TKEY and TDAT block reused as-is instead of _GXTTable (set when the build cache has a hit)
+    std::string			_splicedBlock;
+
+    GXTTableBlockInfo(const FixedName8& tableName, GXTEnum::eGXTVersion fileVersion)
     {
         _tableName = tableName;
         _GXTTable = std::move(GXTTableBase::InstantiateGXTTable(fileVersion));
     }
 
-    GXTTableBlockInfo(std::string tableName, uint32_t absoluteOffset, const GXTEnum::eGXTVersion fileVersion)
+    GXTTableBlockInfo(const FixedName8& tableName, uint32_t absoluteOffset, const GXTEnum::eGXTVersion fileVersion)
     {
         _absoluteOffset = absoluteOffset;
         _tableName = tableName;
@@ -74,29 +49,87 @@ public:
         _absoluteOffset = rhs._absoluteOffset;
         _tableName = rhs._tableName;
         _GXTTable = std::move(rhs._GXTTable);
+        _sourceDigest = rhs._sourceDigest;
+        _splicedBlock = std::move(rhs._splicedBlock);
+    }
+
+    bool IsSpliced() const
+    {
+        return !_splicedBlock.empty();
+    }
+
+    size_t GetBlockSize()
+    {
+        return IsSpliced() ? _splicedBlock.size() : _GXTTable->GetTKEYAndTDATBlockSize();
     }
+
+    void WriteOutBlock(std::ostream& stream)
+    {
+        if (IsSpliced())
+        {
+            stream.write(_splicedBlock.data(), _splicedBlock.size());
+        }
+        else
+        {
+            _GXTTable->WriteTKEYAndTDATBlock(stream);
+        }
+    }
+};
+
+// Layout of a table after replacing, see GXTTableCollection::PlanReplaceText
+struct GXTTablePlan
+{
+    FixedName8	tableName;
+    size_t		entryCount = 0;
+    size_t		TKEYBlockSize = 0;
+    size_t		TDATBlockSize = 0;
+    // Offset written to TABL
+    uint32_t	tableOffset = 0;
+    // Whether the text folder of the table exists
+    bool		hasTexts = false;
+};
+
+struct GXTFilePlan
+{
+    // In TABL order, the main table first
+    std::vector<GXTTablePlan>	tables;
+    uint32_t					fileSize = 0;
 };
 
 class GXTTableCollection
 {
 public:
     GXTTableBlockInfo _mainTable;
-    std::map<std::string, std::unique_ptr<GXTTableBlockInfo>> _missionTable;
+    std::map<FixedName8, std::unique_ptr<GXTTableBlockInfo>> _missionTable;
 
-    GXTTableCollection(std::string& tableName, uint32_t absoluteMainTableOffset, GXTEnum::eGXTVersion fileVersion);
+    GXTTableCollection(const FixedName8& tableName, uint32_t absoluteMainTableOffset, GXTEnum::eGXTVersion fileVersion);
 
     GXTTableBlockInfo& GetMainTable()
     {
         return _mainTable;
     }
-    std::map<std::string, std::unique_ptr<GXTTableBlockInfo>>& GetMissionTableMap()
+    std::map<FixedName8, std::unique_ptr<GXTTableBlockInfo>>& GetMissionTableMap()
     {
         return _missionTable;
     }
 
+    // Returns nullptr if there's no such table
+    GXTTableBlockInfo* FindTable(const FixedName8& tableName);
+    GXTTableBlockInfo* FindTable(const std::string& tableName)
+    {
+        return FindTable(FixedName8(tableName));
+    }
+
     bool WriteGXTFile(const std::wstring& fileName);
-    void AddNewMissionTable(std::string& tableName, uint32_t absoluteTableOffset);
-    void BulkReplaceText(std::wstring& textSourceDirectory, GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage, std::ofstream& logFile);
+    // Size of the file WriteGXTFile would write now
+    uint32_t ComputeFileSize();
+    // Computes the table sizes and offsets BulkReplaceText and WriteGXTFile would produce without replacing or writing anything
+    GXTFilePlan PlanReplaceText(const std::wstring& textSourceDirectory, const TextConverter& textConverter, DiagnosticLog& log);
+    void AddNewMissionTable(const FixedName8& tableName, uint32_t absoluteTableOffset);
+    // Deep copy, so several outputs can be replaced from one parsed file
+    std::unique_ptr<GXTTableCollection> Clone() const;
+    void BulkReplaceText(std::wstring& textSourceDirectory, GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage, DiagnosticLog& log, BuildCache* buildCache = nullptr);
+    void BulkReplaceText(const std::wstring& textSourceDirectory, const TextConverter& textConverter, DiagnosticLog& log, BuildCache* buildCache = nullptr);
 
     bool HasAnyMissionTables()
     {
@@ -108,115 +141,15 @@ public:
     }
 
 private:
-    GXTEnum::eGXTVersion _fileVersion;
-};
-
-namespace VC
-{
-    class GXTTable : public GXTTableBase
-    {
-    public:
-        typedef uint16_t character_t;
-
-        GXTTable(std::wstring szFilePath)
-            : GXTTableBase(std::move(szFilePath))
-        {}
-        GXTTable() : GXTTableBase()
-        {}
+    // TKEY and TDAT block sizes of the tables, the main table first
+    std::vector<size_t> GetBlockSizes();
+    // Returns the TABL offsets of the tables (the main table first) whose TKEY and TDAT blocks have the given sizes,
+    // fileSize receives the size of the whole file
+    std::vector<uint32_t> ComputeTableOffsets(const std::vector<size_t>& blockSizes, uint32_t& fileSize) const;
 
-        virtual size_t	GetNumEntries() override
-        {
-            return Entries.size();
-        }
-
-        virtual size_t GetFormattedContentSize() override
-        {
-            return FormattedContent.size() * sizeof(character_t);
-        }
-
-        virtual size_t GetEntrySize() override
-        {
-            return GXT_ENTRY_NAME_LEN + sizeof(uint32_t);
-        }
-
-        virtual bool UsesHashForEntryName() override
-        {
-            return false;
-        }
-        virtual bool InsertEntry(const uint32_t, uint32_t) override
-        {
-            return false;
-        }
-        virtual bool ReplaceEntries(const std::unordered_map<uint32_t, std::string>&) override
-        {
-            return false;
-        }
-
-        virtual bool	InsertEntry(const std::string& entryName, uint32_t offset) override;
-        virtual bool	ReplaceEntries(const std::unordered_map<std::string, std::wstring>& entryMap) override;
-        virtual void	WriteOutEntries(std::ostream& stream) override;
-        virtual void	WriteOutContent(std::ostream& stream) override;
-        virtual void	ReadEntireContent(std::ifstream& inputStream, const uint32_t offset, const size_t size) override;
-        virtual void	PushFormattedChar(int character) override;
-
-    private:
-        static const size_t	GXT_ENTRY_NAME_LEN = 8;
-
-        std::map<std::string, uint32_t>	Entries;
-        std::wstring FormattedContent;
-    };
+    GXTEnum::eGXTVersion _fileVersion;
 };
 
-namespace SA
-{
-    class GXTTable : public GXTTableBase
-    {
-    public:
-        typedef uint8_t character_t;
-
-        GXTTable(std::wstring szFilePath)
-            : GXTTableBase(std::move(szFilePath))
-        {}
-        GXTTable() : GXTTableBase()
-        {}
-
-        virtual size_t	GetNumEntries() override
-        {
-            return Entries.size();
-        }
-
-        virtual size_t GetFormattedContentSize() override
-        {
-            return FormattedContent.size() * sizeof(character_t);
-        }
-
-        virtual size_t GetEntrySize() override
-        {
-            return sizeof(uint32_t) + sizeof(uint32_t);
-        }
-
-        virtual bool UsesHashForEntryName() override
-        {
-            return true;
-        }
-
-        virtual bool ReplaceEntries(const std::unordered_map<std::string, std::wstring>&) override
-        {
-            return false;
-        }
-
-        virtual bool	InsertEntry(const std::string& entryName, uint32_t offset) override;
-        virtual bool	InsertEntry(const uint32_t crc32EntryHash, uint32_t offset) override;
-        virtual bool    ReplaceEntries(const std::unordered_map<uint32_t, std::string>& entryMap) override;
-        virtual void	WriteOutEntries(std::ostream& stream) override;
-        virtual void	WriteOutContent(std::ostream& stream) override;
-        virtual void	ReadEntireContent(std::ifstream& inputStream, const uint32_t offset, const size_t size) override;
-        virtual void	PushFormattedChar(int character) override;
-
-    private:
-        std::map<uint32_t, uint32_t> Entries;
-        std::string	FormattedContent;
-    };
-};
+std::unique_ptr<GXTTableCollection> ReadGXTFile(const std::wstring& fileName, const GXTEnum::eGXTVersion fileVersion, BuildCache* buildCache = nullptr);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "gxt_view.h"
+#include "crc32keygen.h"
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+GXTView::GXTView(const std::wstring& gxtFileName, GXTEnum::eGXTVersion fileVersion)
+    : _fileVersion(fileVersion), _gxtFile(std::make_unique<MappedFile>(gxtFileName))
+{
+    _characterSize = GXTLayout::GetCharacterSize(_gxtFile->GetData(), _gxtFile->GetSize(), fileVersion);
+
+    // Name lookups in VC TKEY blocks need the table layouts, the index only knows hashes
+    if (fileVersion != GXTEnum::eGXTVersion::GXT_VC)
+    {
+        _index = GXTIndex::Open(gxtFileName);
+    }
+    if (_index == nullptr)
+    {
+        _tables = GXTLayout::ScanTables(_gxtFile->GetData(), _gxtFile->GetSize(), fileVersion);
+    }
+}
+
+const GXTTableLayout* GXTView::FindTableLayout(const std::string& tableName) const
+{
+    const FixedName8 name(tableName);
+
+    for (const auto& table : _tables)
+    {
+        if (table.tableName == name)
+        {
+            return &table;
+        }
+    }
+    return nullptr;
+}
+
+std::optional<size_t> GXTView::FindEntryIndex(const GXTTableLayout& table, uint32_t entryHash) const
+{
+    const char* data = _gxtFile->GetData();
+
+    size_t first = 0;
+    size_t last = table.entryCount;
+    while (first < last)
+    {
+        const size_t middle = first + (last - first) / 2;
+        const uint32_t middleHash = GXTLayout::GetEntryKey(data, table, middle, _fileVersion);
+        if (middleHash < entryHash)
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+
+    if (first < table.entryCount && GXTLayout::GetEntryKey(data, table, first, _fileVersion) == entryHash)
+    {
+        return first;
+    }
+    return std::nullopt;
+}
+
+std::optional<size_t> GXTView::FindEntryIndex(const GXTTableLayout& table, const std::string& entryName) const
+{
+    const char* data = _gxtFile->GetData();
+    const size_t ONE_ENTRY_SIZE = GXTLayout::GetEntrySize(_fileVersion);
+
+    const FixedName8 name(entryName);
+
+    size_t first = 0;
+    size_t last = table.entryCount;
+    while (first < last)
+    {
+        const size_t middle = first + (last - first) / 2;
+        const char* middleName = data + table.entriesOffset + middle * ONE_ENTRY_SIZE + sizeof(uint32_t);
+        if (FixedName8::Read(middleName) < name)
+        {
+            first = middle + 1;
+        }
+        else
+        {
+            last = middle;
+        }
+    }
+
+    if (first < table.entryCount && FixedName8::Read(data + table.entriesOffset + first * ONE_ENTRY_SIZE + sizeof(uint32_t)) == name)
+    {
+        return first;
+    }
+    return std::nullopt;
+}
+
+std::string_view GXTView::GetContent(uint32_t contentOffset, uint32_t contentSize, uint32_t entryOffset) const
+{
+    if (entryOffset >= contentSize)
+    {
+        return std::string_view();
+    }
+
+    const char* begin = _gxtFile->GetData() + contentOffset + entryOffset;
+    const char* end = _gxtFile->GetData() + contentOffset + contentSize;
+
+    if (_characterSize == 1)
+    {
+        const void* terminator = std::memchr(begin, '\0', end - begin);
+        return std::string_view(begin, terminator != nullptr ? static_cast<const char*>(terminator) - begin : end - begin);
+    }
+
+    const char* it = begin;
+    while (it + 1 < end && (it[0] != '\0' || it[1] != '\0'))
+    {
+        it += 2;
+    }
+    return std::string_view(begin, it - begin);
+}
+
+std::optional<std::string_view> GXTView::FindEntry(const std::string& tableName, uint32_t entryHash) const
+{
+    if (_index != nullptr)
+    {
+        const GXTIndexTable* table = _index->FindTable(tableName);
+        if (table == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        const uint32_t* keys = _index->GetKeys(*table);
+        const uint32_t* keysEnd = keys + table->entryCount;
+        const uint32_t* key = std::lower_bound(keys, keysEnd, entryHash);
+        if (key == keysEnd || *key != entryHash)
+        {
+            return std::nullopt;
+        }
+
+        const uint32_t entryOffset = _index->GetEntryOffsets(*table)[key - keys];
+        return GetContent(table->contentOffset, table->contentSize, entryOffset);
+    }
+
+    const GXTTableLayout* table = FindTableLayout(tableName);
+    if (table == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    // VC TKEY blocks are sorted by name, so a hash has to be compared with every entry
+    std::optional<size_t> entryIndex;
+    if (_fileVersion == GXTEnum::eGXTVersion::GXT_VC)
+    {
+        for (size_t i = 0; i < table->entryCount && !entryIndex; i++)
+        {
+            if (GXTLayout::GetEntryKey(_gxtFile->GetData(), *table, i, _fileVersion) == entryHash)
+            {
+                entryIndex = i;
+            }
+        }
+    }
+    else
+    {
+        entryIndex = FindEntryIndex(*table, entryHash);
+    }
+
+    if (!entryIndex)
+    {
+        return std::nullopt;
+    }
+
+    const uint32_t entryOffset = GXTLayout::GetEntryOffset(_gxtFile->GetData(), *table, entryIndex.value(), _fileVersion);
+    return GetContent(table->contentOffset, table->contentSize, entryOffset);
+}
+
+std::optional<std::string_view> GXTView::FindEntry(const std::string& tableName, const std::string& entryName) const
+{
+    if (_fileVersion != GXTEnum::eGXTVersion::GXT_VC)
+    {
+        return FindEntry(tableName, Crc32KeyGen::GetUppercaseKey(entryName.c_str()));
+    }
+
+    // Names are stored and loaded in upper case, like GetUppercaseKey hashes SA names
+    if (entryName.empty() || entryName.size() >= FixedName8::SIZE)
+    {
+        throw std::runtime_error("The entry name " + entryName + " must have 1 to 7 characters!");
+    }
+    std::string upperEntryName = entryName;
+    std::transform(upperEntryName.begin(), upperEntryName.end(), upperEntryName.begin(), ::toupper);
+
+    const GXTTableLayout* table = FindTableLayout(tableName);
+    if (table == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    auto entryIndex = FindEntryIndex(*table, upperEntryName);
+    if (!entryIndex)
+    {
+        return std::nullopt;
+    }
+
+    const uint32_t entryOffset = GXTLayout::GetEntryOffset(_gxtFile->GetData(), *table, entryIndex.value(), _fileVersion);
+    return GetContent(table->contentOffset, table->contentSize, entryOffset);
+}
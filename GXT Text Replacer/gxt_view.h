@@ -0,0 +1,49 @@
+#pragma once
+
+#include "enum.h"
+#include "gxt_index.h"
+#include "mapped_file.h"
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <vector>
+#include <memory>
+
+// Read-only random access to the entries of a mapped GXT file.
+// Tables are located through the .gxtidx sidecar if it's up to date, or through TABL otherwise, and entries are
+// binary-searched in the sorted TKEY block in place. Returned texts point into the mapping and stay valid as long
+// as the view does.
+class GXTView
+{
+public:
+    GXTView(const std::wstring& gxtFileName, GXTEnum::eGXTVersion fileVersion);
+
+    // 1 for 8-bit SA texts, 2 for 16-bit texts
+    size_t GetCharacterSize() const
+    {
+        return _characterSize;
+    }
+    bool UsesIndex() const
+    {
+        return _index != nullptr;
+    }
+
+    // Returns the raw TDAT bytes of the entry without the NUL terminator
+    std::optional<std::string_view> FindEntry(const std::string& tableName, uint32_t entryHash) const;
+    // Entry names are looked up by their CRC32 hash (or by name in VC TKEY blocks), ignoring case. Throws
+    // std::runtime_error if a VC name doesn't have 1 to 7 characters.
+    std::optional<std::string_view> FindEntry(const std::string& tableName, const std::string& entryName) const;
+
+private:
+    const GXTTableLayout* FindTableLayout(const std::string& tableName) const;
+    std::optional<size_t> FindEntryIndex(const GXTTableLayout& table, uint32_t entryHash) const;
+    std::optional<size_t> FindEntryIndex(const GXTTableLayout& table, const std::string& entryName) const;
+    std::string_view GetContent(uint32_t contentOffset, uint32_t contentSize, uint32_t entryOffset) const;
+
+    GXTEnum::eGXTVersion				_fileVersion;
+    std::unique_ptr<MappedFile>			_gxtFile;
+    std::unique_ptr<GXTIndex>			_index;
+    std::vector<GXTTableLayout>			_tables;
+    size_t								_characterSize = 1;
+};
@@ -0,0 +1,225 @@
+#include "gxt_watcher.h"
+#include "gxt_index.h"
+#include "directory_watcher.h"
+#include "platform.h"
+
+#include <iostream>
+#include <chrono>
+#include <cwctype>
+#include <filesystem>
+
+namespace
+{
+    void LoadFileEntries(const std::wstring& fileName, HashEntryMap& entryMap, DiagnosticLog& log)
+    {
+        EntryLoader::LoadFileContentForHashEntry(fileName, entryMap, log);
+    }
+
+    void LoadFileEntries(const std::wstring& fileName, NameEntryMap& entryMap, DiagnosticLog& log)
+    {
+        EntryLoader::LoadFileContent(fileName, entryMap, log);
+    }
+
+    // The first file defining an entry wins, like in EntryLoader::LoadHashEntryTextsInDirectory
+    template<typename EntryMap>
+    EntryMap MergeFileEntries(const std::map<std::wstring, EntryMap>& fileEntries)
+    {
+        EntryMap entryMap;
+        for (const auto& entries : fileEntries)
+        {
+            for (const auto& pair : entries.second)
+            {
+                entryMap.emplace(pair.first, pair.second);
+            }
+        }
+        return entryMap;
+    }
+}
+
+GXTWatcher::GXTWatcher(std::wstring gxtFileName, GXTEnum::eGXTVersion fileVersion, std::wstring textSourceDirectory,
+    const TextConverter& textConverter, DiagnosticLog& log)
+    : _gxtFileName(std::move(gxtFileName)), _fileVersion(fileVersion), _textSourceDirectory(std::move(textSourceDirectory)), _textConverter(textConverter), _log(log)
+{
+    _tableCollection = ReadGXTFile(_gxtFileName, fileVersion);
+
+    auto addTableState = [&](GXTTableBlockInfo& tableInfo)
+    {
+        _tableStates[tableInfo._tableName].originalTable = tableInfo._GXTTable->Clone();
+    };
+
+    addTableState(_tableCollection->GetMainTable());
+    for (auto& missionTable : _tableCollection->GetMissionTableMap())
+    {
+        addTableState(*missionTable.second);
+    }
+}
+
+std::wstring GXTWatcher::GetTextDirectory(const FixedName8& tableName) const
+{
+    return _textSourceDirectory + Platform::PATH_SEPARATOR + Encoding::AnsiStringToWString(tableName.ToString());
+}
+
+void GXTWatcher::LoadTextFile(TableState& tableState, const std::wstring& fileName)
+{
+    const size_t characterSize = tableState.originalTable->GetCharacterSize();
+    if (tableState.originalTable->UsesHashForEntryName())
+    {
+        LoadTextFile(tableState.fileHashEntries, characterSize, fileName);
+    }
+    else
+    {
+        LoadTextFile(tableState.fileNameEntries, characterSize, fileName);
+    }
+}
+
+template<typename EntryMap>
+void GXTWatcher::LoadTextFile(std::map<std::wstring, EntryMap>& fileEntries, size_t characterSize, const std::wstring& fileName)
+{
+    if (!std::filesystem::exists(Platform::ToPath(fileName)))
+    {
+        fileEntries.erase(fileName);
+        return;
+    }
+
+    // Keep the previous texts of the file if it can't be loaded or converted, e.g. while an editor is still saving it
+    try
+    {
+        EntryMap entryMap;
+        LoadFileEntries(fileName, entryMap, _log);
+        _textConverter.ConvertFromUtf8(entryMap, characterSize);
+
+        fileEntries[fileName] = std::move(entryMap);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "ERROR: " << e.what() << "\n";
+    }
+}
+
+void GXTWatcher::LoadAllTextFiles(const FixedName8& tableName)
+{
+    TableState& tableState = _tableStates[tableName];
+    tableState.fileHashEntries.clear();
+    tableState.fileNameEntries.clear();
+
+    const std::wstring textDirectory = GetTextDirectory(tableName);
+    if (!Directory::Exists(textDirectory))
+    {
+        return;
+    }
+
+    for (auto & p : std::filesystem::directory_iterator(Platform::ToPath(textDirectory)))
+    {
+        if (p.path().extension() == ".txt")
+        {
+            LoadTextFile(tableState, Platform::FromPath(p.path()));
+        }
+    }
+}
+
+void GXTWatcher::RebuildTable(const FixedName8& tableName)
+{
+    TableState& tableState = _tableStates[tableName];
+
+    GXTTableBlockInfo* tableInfo = _tableCollection->FindTable(tableName);
+    tableInfo->_GXTTable = tableState.originalTable->Clone();
+    if (tableState.originalTable->UsesHashForEntryName())
+    {
+        tableInfo->_GXTTable->ReplaceEntries(MergeFileEntries(tableState.fileHashEntries));
+    }
+    else
+    {
+        tableInfo->_GXTTable->ReplaceEntries(MergeFileEntries(tableState.fileNameEntries));
+    }
+}
+
+void GXTWatcher::WriteOutput()
+{
+    _log.Flush();
+    _tableCollection->WriteGXTFile(_gxtFileName);
+    if (std::filesystem::exists(Platform::ToPath(GXTIndex::GetIndexFileName(_gxtFileName))))
+    {
+        GXTIndex::Build(_gxtFileName, _fileVersion);
+    }
+}
+
+void GXTWatcher::Run()
+{
+    using clock = std::chrono::steady_clock;
+
+    for (const auto& tableState : _tableStates)
+    {
+        LoadAllTextFiles(tableState.first);
+        RebuildTable(tableState.first);
+    }
+    WriteOutput();
+
+    DirectoryWatcher directoryWatcher(_textSourceDirectory);
+    std::wcout << L"Watching " << _textSourceDirectory << L" for changes...\n";
+
+    for (;;)
+    {
+        const auto changedPaths = directoryWatcher.WaitForChanges(_changedFiles.empty() ? 0xFFFFFFFF : DEBOUNCE_MILLISECONDS);
+
+        if (changedPaths.empty())
+        {
+            if (_changedFiles.empty())
+            {
+                continue;
+            }
+
+            const auto startTime = clock::now();
+            for (const auto& pair : _changedFiles)
+            {
+                TableState& tableState = _tableStates[pair.first];
+                for (const auto& fileName : pair.second)
+                {
+                    if (fileName == DirectoryWatcher::RESCAN_ALL)
+                    {
+                        LoadAllTextFiles(pair.first);
+                        break;
+                    }
+                    LoadTextFile(tableState, fileName);
+                }
+                RebuildTable(pair.first);
+            }
+            _changedFiles.clear();
+
+            WriteOutput();
+            std::wcout << L"Rebuilt in " << std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - startTime).count() << L" ms\n";
+            continue;
+        }
+
+        for (const auto& changedPath : changedPaths)
+        {
+            if (changedPath == DirectoryWatcher::RESCAN_ALL)
+            {
+                for (const auto& tableState : _tableStates)
+                {
+                    _changedFiles[tableState.first].insert(DirectoryWatcher::RESCAN_ALL);
+                }
+                continue;
+            }
+
+            // Only <table>\<file>.txt is read, there's no recursive search
+            const std::wstring::size_type separatorPos = changedPath.find_first_of(L"/\\");
+            if (separatorPos == std::wstring::npos || changedPath.find_first_of(L"/\\", separatorPos + 1) != std::wstring::npos
+                || changedPath.size() < 4 || changedPath.compare(changedPath.size() - 4, 4, L".txt") != 0)
+            {
+                continue;
+            }
+
+            std::string upperTableName;
+            for (wchar_t c : changedPath.substr(0, separatorPos))
+            {
+                upperTableName.push_back(static_cast<char>(std::towupper(c)));
+            }
+            const FixedName8 tableName(upperTableName);
+
+            if (_tableStates.find(tableName) != _tableStates.end())
+            {
+                _changedFiles[tableName].insert(GetTextDirectory(tableName) + changedPath.substr(separatorPos));
+            }
+        }
+    }
+}
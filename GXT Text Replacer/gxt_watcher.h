@@ -0,0 +1,54 @@
+#pragma once
+
+#include "gxt_text_replacer.h"
+#include "utility.h"
+
+#include <string>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <memory>
+
+// Keeps the parsed GXT file, the text converter and the entries of every text file in memory and rebuilds only the
+// tables whose text files changed. The original tables are kept, so removed entries fall back to their original texts.
+class GXTWatcher
+{
+public:
+    // Changes are collected until no file has changed for this long, then the GXT file is written once
+    static constexpr uint32_t DEBOUNCE_MILLISECONDS = 200;
+
+    GXTWatcher(std::wstring gxtFileName, GXTEnum::eGXTVersion fileVersion, std::wstring textSourceDirectory,
+        const TextConverter& textConverter, DiagnosticLog& log);
+
+    // Builds every table once and then watches the text folder until the process is terminated
+    void Run();
+
+private:
+    struct TableState
+    {
+        std::unique_ptr<GXTTableBase>	originalTable;
+        // Converted entries of every text file in the table's folder, keyed by hash in SA files and by name in VC files
+        std::map<std::wstring, HashEntryMap>	fileHashEntries;
+        std::map<std::wstring, NameEntryMap>	fileNameEntries;
+    };
+
+    void LoadAllTextFiles(const FixedName8& tableName);
+    void LoadTextFile(TableState& tableState, const std::wstring& fileName);
+    template<typename EntryMap>
+    void LoadTextFile(std::map<std::wstring, EntryMap>& fileEntries, size_t characterSize, const std::wstring& fileName);
+    void RebuildTable(const FixedName8& tableName);
+    void WriteOutput();
+
+    std::wstring GetTextDirectory(const FixedName8& tableName) const;
+
+    std::wstring							_gxtFileName;
+    GXTEnum::eGXTVersion					_fileVersion;
+    std::wstring							_textSourceDirectory;
+    const TextConverter&					_textConverter;
+    DiagnosticLog&							_log;
+    std::unique_ptr<GXTTableCollection>		_tableCollection;
+
+    std::map<FixedName8, TableState>		_tableStates;
+    // Changed text files per table since the last rebuild
+    std::map<FixedName8, std::set<std::wstring>>	_changedFiles;
+};
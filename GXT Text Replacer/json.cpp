@@ -0,0 +1,250 @@
+#include "json.h"
+#include "utf8.h"
+
+#include <stdexcept>
+#include <iterator>
+
+namespace
+{
+    class FlatObjectParser
+    {
+    public:
+        explicit FlatObjectParser(const std::string& text)
+            : _text(text)
+        {}
+
+        std::unordered_map<std::string, JsonValue> Parse()
+        {
+            std::unordered_map<std::string, JsonValue> members;
+
+            Expect('{');
+            SkipWhitespace();
+            if (Peek() == '}')
+            {
+                _pos++;
+                return members;
+            }
+
+            for (;;)
+            {
+                SkipWhitespace();
+                std::string key = ParseString();
+                Expect(':');
+                SkipWhitespace();
+
+                JsonValue value;
+                if (Peek() == '"')
+                {
+                    value.isString = true;
+                    value.value = ParseString();
+                }
+                else
+                {
+                    value.value = ParseToken();
+                }
+                members[key] = std::move(value);
+
+                SkipWhitespace();
+                const char separator = Next();
+                if (separator == '}')
+                {
+                    break;
+                }
+                if (separator != ',')
+                {
+                    Fail("',' or '}' expected");
+                }
+            }
+
+            SkipWhitespace();
+            if (_pos != _text.size())
+            {
+                Fail("unexpected data after the object");
+            }
+            return members;
+        }
+
+    private:
+        [[noreturn]] void Fail(const char* message)
+        {
+            throw std::runtime_error(std::string("Invalid JSON: ") + message + " at column " + std::to_string(_pos + 1));
+        }
+
+        char Peek()
+        {
+            return _pos < _text.size() ? _text[_pos] : '\0';
+        }
+
+        char Next()
+        {
+            if (_pos >= _text.size())
+            {
+                Fail("unexpected end of line");
+            }
+            return _text[_pos++];
+        }
+
+        void Expect(char c)
+        {
+            SkipWhitespace();
+            if (Next() != c)
+            {
+                Fail((std::string("'") + c + "' expected").c_str());
+            }
+        }
+
+        void SkipWhitespace()
+        {
+            while (_pos < _text.size() && (_text[_pos] == ' ' || _text[_pos] == '\t' || _text[_pos] == '\r' || _text[_pos] == '\n'))
+            {
+                _pos++;
+            }
+        }
+
+        uint32_t ParseHex4()
+        {
+            uint32_t value = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                const char c = Next();
+                value <<= 4;
+                if (c >= '0' && c <= '9')
+                    value |= c - '0';
+                else if (c >= 'a' && c <= 'f')
+                    value |= c - 'a' + 10;
+                else if (c >= 'A' && c <= 'F')
+                    value |= c - 'A' + 10;
+                else
+                    Fail("invalid \\u escape");
+            }
+            return value;
+        }
+
+        std::string ParseString()
+        {
+            if (Next() != '"')
+            {
+                Fail("string expected");
+            }
+
+            std::string result;
+            for (;;)
+            {
+                const char c = Next();
+                if (c == '"')
+                {
+                    break;
+                }
+                if (c != '\\')
+                {
+                    result.push_back(c);
+                    continue;
+                }
+
+                const char escaped = Next();
+                switch (escaped)
+                {
+                case '"': result.push_back('"'); break;
+                case '\\': result.push_back('\\'); break;
+                case '/': result.push_back('/'); break;
+                case 'b': result.push_back('\b'); break;
+                case 'f': result.push_back('\f'); break;
+                case 'n': result.push_back('\n'); break;
+                case 'r': result.push_back('\r'); break;
+                case 't': result.push_back('\t'); break;
+                case 'u':
+                {
+                    uint32_t codePoint = ParseHex4();
+                    if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+                    {
+                        if (Next() != '\\' || Next() != 'u')
+                        {
+                            Fail("low surrogate expected");
+                        }
+                        const uint32_t lowSurrogate = ParseHex4();
+                        if (lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF)
+                        {
+                            Fail("invalid low surrogate");
+                        }
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                    }
+                    else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+                    {
+                        Fail("unexpected low surrogate");
+                    }
+                    utf8::append(codePoint, std::back_inserter(result));
+                }
+                    break;
+                default:
+                    Fail("invalid escape");
+                }
+            }
+            return result;
+        }
+
+        std::string ParseToken()
+        {
+            const size_t start = _pos;
+            while (_pos < _text.size() && _text[_pos] != ',' && _text[_pos] != '}' && _text[_pos] != ' ' && _text[_pos] != '\t')
+            {
+                if (_text[_pos] == '{' || _text[_pos] == '[')
+                {
+                    Fail("nested values aren't supported");
+                }
+                _pos++;
+            }
+            if (start == _pos)
+            {
+                Fail("value expected");
+            }
+            return _text.substr(start, _pos - start);
+        }
+
+        const std::string&	_text;
+        size_t				_pos = 0;
+    };
+}
+
+std::unordered_map<std::string, JsonValue> Json::ParseFlatObject(const std::string& text)
+{
+    return FlatObjectParser(text).Parse();
+}
+
+std::string Json::Escape(const std::string& utf8)
+{
+    static const char hexDigits[] = "0123456789abcdef";
+
+    std::string result;
+    result.reserve(utf8.size() + 2);
+    result.push_back('"');
+    for (char c : utf8)
+    {
+        switch (c)
+        {
+        case '"': result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                result += "\\u00";
+                result.push_back(hexDigits[(c >> 4) & 0xF]);
+                result.push_back(hexDigits[c & 0xF]);
+            }
+            else
+            {
+                result.push_back(c);
+            }
+            break;
+        }
+    }
+    result.push_back('"');
+    return result;
+}
+
+std::string Json::ToJson(const JsonValue& value)
+{
+    return value.isString ? Escape(value.value) : value.value;
+}
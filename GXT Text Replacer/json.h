@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+struct JsonValue
+{
+    bool			isString = false;
+    // Unescaped UTF-8 for strings, the raw token for numbers, booleans and null
+    std::string		value;
+};
+
+// Just enough JSON for line-based protocols: flat objects in, escaped strings out
+class Json
+{
+public:
+    // Throws std::runtime_error on malformed input or nested objects and arrays
+    static std::unordered_map<std::string, JsonValue> ParseFlatObject(const std::string& text);
+    // Returns the quoted and escaped JSON string
+    static std::string Escape(const std::string& utf8);
+    // Writes a parsed value back (quoted if it was a string)
+    static std::string ToJson(const JsonValue& value);
+};
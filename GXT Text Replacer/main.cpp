@@ -0,0 +1,708 @@
+#include "gxt_text_replacer.h"
+#include "utility.h"
+#include "build_cache.h"
+#include "gxt_index.h"
+#include "gxt_view.h"
+#include "gxt_server.h"
+#include "gxt_watcher.h"
+#include "size_budget.h"
+#include "synthetic_gxt.h"
+#include "build_stats.h"
+#include "build_trace.h"
+#include "diagnostic_log.h"
+#include "gxt_extractor.h"
+#include "gxt_builder.h"
+#include "gxt_batch.h"
+#include "platform.h"
+
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <optional>
+#include <filesystem>
+#include <chrono>
+#include <clocale>
+#include <algorithm>
+
+#if defined(_WIN32) && !defined(UNICODE)
+#error GXT Builder must be compiled with Unicode character set
+#endif
+
+static void PrintPlan(const GXTFilePlan& plan, uint64_t currentFileSize)
+{
+    std::cout << std::left << std::setw(10) << "Table" << std::right << std::setw(10) << "Entries" << std::setw(12) << "TKEY" << std::setw(12) << "TDAT" << std::setw(12) << "Offset" << "\n";
+    for (const auto& tablePlan : plan.tables)
+    {
+        std::cout << std::left << std::setw(10) << tablePlan.tableName.ToString() << std::right << std::setw(10) << tablePlan.entryCount
+            << std::setw(12) << tablePlan.TKEYBlockSize << std::setw(12) << tablePlan.TDATBlockSize << std::setw(12) << tablePlan.tableOffset
+            << (tablePlan.hasTexts ? "" : "  (no texts)") << "\n";
+    }
+    std::cout << "File size: " << plan.fileSize << " bytes (currently " << currentFileSize << " bytes)\n";
+}
+
+const wchar_t* GetFormatName(GXTEnum::eGXTVersion version)
+{
+    switch (version)
+    {
+    case GXTEnum::eGXTVersion::GXT_VC:
+        return L"GTA Vice City";
+    case GXTEnum::eGXTVersion::GXT_SA:
+        return L"GTA San Andreas";
+    case GXTEnum::eGXTVersion::GXT_SA_MOBILE:
+        return L"GTA San Andreas (mobile)";
+    case GXTEnum::eGXTVersion::GXT_SA_16BIT:
+        return L"GTA San Andreas (16-bit)";
+    }
+    return L"Unsupported";
+}
+
+// Keeps the folder, so the files named after a GXT file are written next to it
+std::wstring GetPathNoExtension(std::wstring path)
+{
+    std::wstring::size_type namePos = path.find_last_of(L"/\\");
+    std::wstring::size_type extPos = path.find_last_of(L'.');
+    if (extPos != std::wstring::npos && (namePos == std::wstring::npos || extPos > namePos))
+        path.erase(extPos);
+    return path;
+}
+
+std::wstring GetFileNameNoExtension(std::wstring path)
+{
+    path = GetPathNoExtension(path);
+    std::wstring::size_type namePos = path.find_last_of(L"/\\");
+    if (namePos != std::wstring::npos)
+        path = path.substr(namePos + 1);
+    return path;
+}
+
+std::wstring GetFileExtension(std::wstring path)
+{
+    std::wstring::size_type extPos = path.find_last_of(L'.');
+    if (extPos != std::wstring::npos)
+        path = path.substr(extPos, path.length() - extPos);
+    else
+        path = std::wstring();
+    return path;
+}
+
+static const char* const helpText = "Usage:\tgxt_text_replacer [GXT filename] [Text folder] [-usecharmap] [-ansitext] [-unicodetext] [-ansicodepage (value)] [-vc] [-nocache] [-writeindex] [-watch] [-plan] [-budget (file)] [-stats] [-statsjson (file)] [-trace (file)] [-logjson] [-loglevel (warning or error)]\n"
+"\tgxt_text_replacer index [GXT filename] [-vc] [-16bit]\n"
+"\tgxt_text_replacer get [GXT filename] [Table name] [Entry name or 0xHASH]... [-vc] [-16bit]\n"
+"\tgxt_text_replacer serve [GXT filename] [-usecharmap] [-ansitext] [-unicodetext] [-ansicodepage (value)] [-vc]\n"
+"\tgxt_text_replacer serve-bench [GXT filename] [Table name] [Request count] [Batch size] [options of serve]\n"
+"\tgxt_text_replacer build [Project INI] [GXT filename] [-usecharmap] [-ansitext] [-unicodetext] [-ansicodepage (value)] [-vc]\n"
+"\tgxt_text_replacer extract [GXT filename] [Text folder] [-usecharmap] [-ansitext] [-unicodetext] [-ansicodepage (value)] [-vc]\n"
+"\tgxt_text_replacer batch [Manifest] [-logjson] [-loglevel (warning or error)]\n"
+"\tgxt_text_replacer generate [GXT filename] [Text folder] [-vc] [-16bit] [-missiontables (count)] [-entries (count)] [-length (min) (max)] [-skewed] [-shared (ratio)] [-replace (ratio)] [-alphabet (ascii, latin1 or cjk)] [-seed (value)]\n"
+"IMPORTANT: Currently, only SA and VC GXT for non-remastered versions are supported.\n"
+"\t-ansitext - Convert texts into ansi characters (the current default setting)\n"
+"\t-unicodetext - Convert texts into UTF-16 texts if GXT file content uses 16 bit char text, or doesn't convert if GXT file content uses 8 bit char text\n"
+"\t-ansicodepage - Specify ANSI code page for converting text into ANSI ones\n"
+"\t-usecharmap - Convert texts using character map (not recommended because non-ASCII characters are currently not supported)\n"
+"\t-vc - The GXT file is a VC GXT file, whose texts are 16-bit and whose entries are keyed by names (the default is SA)\n"
+"\t-16bit - The GXT file is a SA GXT file with 16-bit texts. SA files are detected from the header anyway, this fails if the header says otherwise\n"
+"\t-nocache - Don't use the build cache ([GXT name]_replace.cache), which lets unchanged tables skip parsing and replacing\n"
+"\t-writeindex - Write the lookup index ([GXT name].gxtidx) after replacing (an existing index is always kept up to date)\n"
+"\t-watch - Keep running after replacing and rebuild the tables whose text files changed (the build cache isn't used)\n"
+"\t-plan - Only print the table sizes and offsets and the file size replacing would produce, without writing anything\n"
+"\t-budget - Check the TKEY and TDAT sizes of the tables and the file size against the budgets in the file after replacing, and don't write the GXT file if one is exceeded\n"
+"\t-stats - Print the time of every build phase and the entries, bytes, files and allocations per table after writing\n"
+"\t-statsjson - Write the -stats report to the file as JSON\n"
+"\t-logjson - Write the log ([GXT name]_replace.log) as JSON lines with the severity, table, file, line, entry and hash of every record\n"
+"\t-loglevel - Only log records of this severity or higher (default warning), every record is still counted in the summary\n"
+"\t-trace - Write the begin and end of every phase, table and worker chunk on every thread to the file in the Chrome trace-event format (chrome://tracing, Perfetto)\n"
+"\tindex - Only write the lookup index of the GXT file\n"
+"\tget - Print the raw texts of entries, one per line, without parsing the whole GXT file\n"
+"\tserve - Keep the GXT file loaded and answer newline-delimited JSON requests (get, set, replace, flush, quit) on stdin\n"
+"\tserve-bench - Measure requests per second and latency of the serve mode with the entries of a table\n"
+"\tbuild - Create a GXT file from the text folders listed in a GXT builder project (see doc/american.ini), the GXT file defaults to the project name. The charmap and version of the project override -usecharmap and -vc\n"
+"\textract - Write the entries of every table to [Text folder]\\[Table]\\[Table].txt as UTF-8, converted with the same options as replacing, so replacing with the folder gives back the same GXT file\n"
+"\tbatch - Replace the texts of every language listed in the manifest in one process, sharing the character maps and GXT files the languages have in common. Every line is [GXT file], [Text folder], [Mode (ansi, unicode, charmap or charmap:file)], [Code page or -], [Output GXT or -] and optionally [sa, sa16 or vc], separated by tabs\n"
+"\tgenerate - Write a GXT file with generated tables and entries, a text folder that replaces some of them and a charmap.txt next to the GXT file\n"
+"\t\t-16bit - Generate a SA GXT file with 16-bit texts\n"
+"\t\t-missiontables - The number of mission tables (default 8)\n"
+"\t\t-entries - The number of entries per table (default 1000)\n"
+"\t\t-length - The minimum and maximum text length in characters (default 4 and 64)\n"
+"\t\t-skewed - Make most texts short with a few long ones, instead of spreading the lengths evenly\n"
+"\t\t-shared - The ratio of entries sharing the text of another entry (default 0)\n"
+"\t\t-replace - The ratio of entries the text folder replaces (default 0.1)\n"
+"\t\t-alphabet - The characters of the texts (default ascii), 8-bit SA files store CJK texts as character map bytes\n"
+"\t\t-seed - The seed of the generated content (default 1)\n";
+
+struct CommandLineOptions
+{
+    GXTEnum::eGXTVersion fileVersion = GXTEnum::eGXTVersion::GXT_SA;
+    GXTEnum::eTextConvertingMode textConvMode = GXTEnum::eTextConvertingMode::UseAnsi;
+    int ansiCodePage = Platform::GetAnsiCodePage();
+    bool useBuildCache = true;
+    bool writeIndex = false;
+    bool watch = false;
+    bool plan = false;
+    bool stats = false;
+    std::wstring budgetFileName;
+    std::wstring statsJsonFileName;
+    std::wstring traceFileName;
+    DiagnosticLog::eFormat logFormat = DiagnosticLog::FormatText;
+    DiagnosticLog::eSeverity logLevel = DiagnosticLog::SeverityWarning;
+};
+
+// Options may follow the positional arguments in any order
+static CommandLineOptions ParseOptions(const std::vector<std::wstring>& argvStr, size_t firstOption)
+{
+    CommandLineOptions options;
+
+    for (size_t i = firstOption; i < argvStr.size(); ++i)
+    {
+        const std::wstring&	tmp = argvStr[i];
+        if (tmp.empty() || tmp[0] != '-')
+            continue;
+
+        if (tmp == L"-ansitext")
+            options.textConvMode = GXTEnum::eTextConvertingMode::UseAnsi;
+        if (tmp == L"-usecharmap")
+            options.textConvMode = GXTEnum::eTextConvertingMode::UseCharacterMap;
+        if (tmp == L"-unicodetext")
+            options.textConvMode = GXTEnum::eTextConvertingMode::UseUtf8OrUtf16;
+        if (tmp == L"-vc")
+            options.fileVersion = GXTEnum::eGXTVersion::GXT_VC;
+        if (tmp == L"-16bit")
+            options.fileVersion = GXTEnum::eGXTVersion::GXT_SA_16BIT;
+        if (tmp == L"-nocache")
+            options.useBuildCache = false;
+        if (tmp == L"-writeindex")
+            options.writeIndex = true;
+        if (tmp == L"-watch" || tmp == L"--watch")
+            options.watch = true;
+        if (tmp == L"-plan" || tmp == L"--plan")
+            options.plan = true;
+        if (tmp == L"-stats" || tmp == L"--stats")
+            options.stats = true;
+        if (tmp == L"-logjson" || tmp == L"--log-json")
+            options.logFormat = DiagnosticLog::FormatJsonLines;
+
+        if (tmp == L"-ansicodepage" && i + 1 < argvStr.size())
+        {
+            options.ansiCodePage = std::stoi(argvStr[++i]);
+        }
+        if (tmp == L"-budget" && i + 1 < argvStr.size())
+        {
+            options.budgetFileName = argvStr[++i];
+        }
+        if ((tmp == L"-statsjson" || tmp == L"--stats-json") && i + 1 < argvStr.size())
+        {
+            options.statsJsonFileName = argvStr[++i];
+        }
+        if ((tmp == L"-trace" || tmp == L"--trace") && i + 1 < argvStr.size())
+        {
+            options.traceFileName = argvStr[++i];
+        }
+        if ((tmp == L"-loglevel" || tmp == L"--log-level") && i + 1 < argvStr.size())
+        {
+            const std::wstring& level = argvStr[++i];
+            const auto severity = DiagnosticLog::ParseSeverity(std::string(level.begin(), level.end()));
+            if (severity)
+                options.logLevel = severity.value();
+            else
+                std::cerr << "WARNING: Unknown log level " << std::string(level.begin(), level.end()) << ", warnings and errors are logged!\n";
+        }
+    }
+
+    return options;
+}
+
+// A count of at least 1, std::stoul alone accepts 0, signs and trailing characters
+static size_t ParsePositiveCount(const std::wstring& value, const std::string& description)
+{
+    if (value.empty() || value.size() > 9 || !std::all_of(value.begin(), value.end(), [](wchar_t c) { return c >= L'0' && c <= L'9'; })
+        || std::stoul(value) == 0)
+    {
+        throw std::runtime_error("The " + description + " " + std::string(value.begin(), value.end()) + " isn't a number from 1 to 999999999!");
+    }
+    return std::stoul(value);
+}
+
+static SyntheticGXTSettings ParseGenerateOptions(const std::vector<std::wstring>& argvStr, size_t firstOption)
+{
+    SyntheticGXTSettings settings;
+
+    for (size_t i = firstOption; i < argvStr.size(); ++i)
+    {
+        const std::wstring&	tmp = argvStr[i];
+        const bool			hasValue = i + 1 < argvStr.size();
+
+        if (tmp == L"-vc")
+            settings.fileVersion = GXTEnum::eGXTVersion::GXT_VC;
+        if (tmp == L"-16bit")
+            settings.fileVersion = GXTEnum::eGXTVersion::GXT_SA_16BIT;
+        if (tmp == L"-skewed")
+            settings.skewedTextLength = true;
+
+        if (tmp == L"-missiontables" && hasValue)
+        {
+            settings.missionTableCount = std::stoul(argvStr[++i]);
+        }
+        if (tmp == L"-entries" && hasValue)
+        {
+            settings.entriesPerTable = std::stoul(argvStr[++i]);
+        }
+        if (tmp == L"-length" && i + 2 < argvStr.size())
+        {
+            settings.minTextLength = std::stoul(argvStr[++i]);
+            settings.maxTextLength = std::stoul(argvStr[++i]);
+        }
+        if (tmp == L"-shared" && hasValue)
+        {
+            settings.sharedOffsetRatio = std::stod(argvStr[++i]);
+        }
+        if (tmp == L"-replace" && hasValue)
+        {
+            settings.replacedRatio = std::stod(argvStr[++i]);
+        }
+        if (tmp == L"-seed" && hasValue)
+        {
+            settings.seed = static_cast<uint32_t>(std::stoul(argvStr[++i]));
+        }
+        if (tmp == L"-alphabet" && hasValue)
+        {
+            const std::wstring& alphabet = argvStr[++i];
+            if (alphabet == L"ascii")
+                settings.alphabet = SyntheticGXTSettings::AlphabetAscii;
+            else if (alphabet == L"latin1")
+                settings.alphabet = SyntheticGXTSettings::AlphabetLatin1;
+            else if (alphabet == L"cjk")
+                settings.alphabet = SyntheticGXTSettings::AlphabetCJK;
+            else
+                throw std::runtime_error("Unknown alphabet " + std::string(alphabet.begin(), alphabet.end()) + "!");
+        }
+    }
+
+    return settings;
+}
+
+int PLATFORM_MAIN(int argc, native_char_t* argv[])
+{
+    std::ios_base::sync_with_stdio(false);
+    Platform::InitializeConsole();
+
+    const std::vector<std::wstring> argvStr = Platform::GetArguments(argc, argv);
+
+    // The protocol owns stdout in serve mode, so progress messages go to stderr
+    if (argc >= 2 && argvStr[1] == L"serve")
+    {
+        std::wcout.rdbuf(std::wcerr.rdbuf());
+    }
+
+    std::wcout << L"GXT Text Replacer v0.9\nMade by kagikn, Special thanks to Silent\n";
+
+    setlocale(LC_CTYPE, "");
+
+    if (argc >= 3)
+    {
+        if (argvStr[1] == L"--help")
+        {
+            std::cout << helpText;
+            return 0;
+        }
+
+        if (argvStr[1] == L"index")
+        {
+            std::wstring GXTName(argvStr[2]);
+            if (GetFileExtension(GXTName).empty())
+            {
+                GXTName += L".gxt";
+            }
+
+            const CommandLineOptions options = ParseOptions(argvStr, 3);
+
+            try
+            {
+                GXTIndex::Build(GXTName, options.fileVersion);
+                std::wcout << L"Finished writing " << GXTIndex::GetIndexFileName(GXTName) << L"!\n";
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+            return 0;
+        }
+
+        if (argvStr[1] == L"get" && argc >= 5)
+        {
+            std::wstring GXTName(argvStr[2]);
+            if (GetFileExtension(GXTName).empty())
+            {
+                GXTName += L".gxt";
+            }
+
+            const CommandLineOptions options = ParseOptions(argvStr, 4);
+
+            try
+            {
+                GXTView view(GXTName, options.fileVersion);
+                const std::string tableName(argvStr[3].begin(), argvStr[3].end());
+
+                int notFoundCount = 0;
+                for (int i = 4; i < argc; ++i)
+                {
+                    const std::string entryName(argvStr[i].begin(), argvStr[i].end());
+                    if (entryName[0] == '-')
+                    {
+                        continue;
+                    }
+
+                    std::optional<std::string_view> entryText;
+                    if (entryName.size() >= 3 && (entryName.compare(0, 2, "0x") == 0 || entryName.compare(0, 2, "0X") == 0))
+                    {
+                        auto hexValue = EntryLoader::HexStringToUInt32(entryName.substr(2));
+                        if (hexValue != std::nullopt)
+                        {
+                            entryText = view.FindEntry(tableName, hexValue.value());
+                        }
+                    }
+                    else
+                    {
+                        entryText = view.FindEntry(tableName, entryName);
+                    }
+
+                    if (entryText)
+                    {
+                        std::cout.write(entryText->data(), entryText->size());
+                    }
+                    else
+                    {
+                        std::cerr << "ERROR: the entry " << entryName << " wasn't found in the table " << tableName << "!\n";
+                        notFoundCount++;
+                    }
+                    std::cout << '\n';
+                }
+
+                return notFoundCount == 0 ? 0 : 1;
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+        }
+
+        if (argvStr[1] == L"build" && argc >= 3)
+        {
+            const std::wstring projectName(argvStr[2]);
+            std::wstring GXTName = GetFileNameNoExtension(projectName) + L".gxt";
+            if (argc >= 4 && argvStr[3][0] != L'-')
+            {
+                GXTName = argvStr[3];
+                if (GetFileExtension(GXTName).empty())
+                {
+                    GXTName += L".gxt";
+                }
+            }
+
+            const CommandLineOptions options = ParseOptions(argvStr, 3);
+
+            try
+            {
+                DiagnosticLog Diagnostics;
+                Diagnostics.Open(GetPathNoExtension(GXTName) + L"_build.log", options.logFormat, options.logLevel);
+
+                const GXTProject project = GXTProject::Load(projectName);
+                const TextConverter textConverter = project.charMapFileName.empty() ? TextConverter(options.textConvMode, options.ansiCodePage)
+                    : TextConverter(GXTEnum::eTextConvertingMode::UseCharacterMap, options.ansiCodePage, project.charMapFileName);
+
+                auto gxt = GXTBuilder::Build(project, project.fileVersion.value_or(options.fileVersion), textConverter, Diagnostics);
+                gxt->WriteGXTFile(GXTName);
+                Diagnostics.PrintSummary(std::cout);
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+            return 0;
+        }
+
+        if (argvStr[1] == L"extract" && argc >= 4)
+        {
+            std::wstring GXTName(argvStr[2]);
+            if (GetFileExtension(GXTName).empty())
+            {
+                GXTName += L".gxt";
+            }
+
+            const CommandLineOptions options = ParseOptions(argvStr, 4);
+
+            try
+            {
+                DiagnosticLog Diagnostics;
+                Diagnostics.Open(GetPathNoExtension(GXTName) + L"_extract.log", options.logFormat, options.logLevel);
+
+                const TextConverter textConverter(options.textConvMode, options.ansiCodePage);
+                auto gxt = ReadGXTFile(GXTName, options.fileVersion);
+                const size_t entryCount = GXTExtractor::Extract(*gxt, argvStr[3], textConverter, Diagnostics);
+
+                std::wcout << L"Extracted " << entryCount << L" entries to " << argvStr[3] << L"\n";
+                Diagnostics.PrintSummary(std::cout);
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+            return 0;
+        }
+
+        if (argvStr[1] == L"batch" && argc >= 3)
+        {
+            const std::wstring manifestName(argvStr[2]);
+            const CommandLineOptions options = ParseOptions(argvStr, 3);
+
+            try
+            {
+                DiagnosticLog Diagnostics;
+                Diagnostics.Open(GetPathNoExtension(manifestName) + L"_batch.log", options.logFormat, options.logLevel);
+
+                const auto startTime = std::chrono::steady_clock::now();
+                const std::vector<GXTBatchJob> jobs = GXTBatch::LoadManifest(manifestName);
+                const std::vector<GXTBatchResult> results = GXTBatch::Run(jobs, Diagnostics);
+                const double totalMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+                size_t failedCount = 0;
+                for (size_t i = 0; i < jobs.size(); i++)
+                {
+                    if (results[i].error.empty())
+                    {
+                        std::wcout << jobs[i].outputFileName << L": " << static_cast<uint64_t>(results[i].milliseconds) << L" ms\n";
+                    }
+                    else
+                    {
+                        std::cerr << "ERROR: " << Platform::FromWide(jobs[i].outputFileName, Platform::CODE_PAGE_UTF8) << ": " << results[i].error << "\n";
+                        failedCount++;
+                    }
+                }
+                std::wcout << L"Finished " << jobs.size() - failedCount << L" of " << jobs.size() << L" languages in " << static_cast<uint64_t>(totalMilliseconds) << L" ms\n";
+                Diagnostics.PrintSummary(std::cout);
+
+                return failedCount == 0 ? 0 : 1;
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+        }
+
+        if (argvStr[1] == L"generate" && argc >= 4)
+        {
+            std::wstring GXTName(argvStr[2]);
+            if (GetFileExtension(GXTName).empty())
+            {
+                GXTName += L".gxt";
+            }
+
+            try
+            {
+                const SyntheticGXTSettings settings = ParseGenerateOptions(argvStr, 4);
+                const size_t replacedCount = SyntheticGXT::Generate(settings, GXTName, argvStr[3]);
+
+                std::wcout << L"Generated " << settings.missionTableCount + 1 << L" tables with " << settings.entriesPerTable << L" entries each, "
+                    << replacedCount << L" of them are replaced by " << argvStr[3] << L"\n";
+                std::wcout << L"Finished writing " << GXTName << L"!\n";
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+            return 0;
+        }
+
+        if ((argvStr[1] == L"serve") || (argvStr[1] == L"serve-bench" && argc >= 6))
+        {
+            std::wstring GXTName(argvStr[2]);
+            if (GetFileExtension(GXTName).empty())
+            {
+                GXTName += L".gxt";
+            }
+
+            const CommandLineOptions options = ParseOptions(argvStr, 3);
+
+            try
+            {
+                size_t requestCount = 0;
+                size_t batchSize = 0;
+                if (argvStr[1] == L"serve-bench")
+                {
+                    requestCount = ParsePositiveCount(argvStr[4], "request count");
+                    batchSize = ParsePositiveCount(argvStr[5], "batch size");
+                }
+
+                DiagnosticLog Diagnostics;
+                Diagnostics.Open(GetPathNoExtension(GXTName) + L"_replace.log", options.logFormat, options.logLevel);
+                const TextConverter textConverter(options.textConvMode, options.ansiCodePage);
+                GXTServer server(GXTName, options.fileVersion, textConverter, Diagnostics);
+
+                if (argvStr[1] == L"serve")
+                {
+                    server.Run(std::cin, std::cout);
+                }
+                else
+                {
+                    const std::string tableName(argvStr[3].begin(), argvStr[3].end());
+                    GXTServerBenchmark::Run(server, tableName, requestCount, batchSize);
+                }
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+            return 0;
+        }
+
+        // A map of GXT tables
+        std::wstring GXTName(argvStr[1]);
+        std::wstring TextDirectoryToReplace(argvStr[2]);
+        DiagnosticLog Diagnostics;
+
+        // Parse commandline arguments
+        const CommandLineOptions options = ParseOptions(argvStr, 3);
+        const GXTEnum::eGXTVersion fileVersion = options.fileVersion;
+        const GXTEnum::eTextConvertingMode textConvMode = options.textConvMode;
+        const int ansiCodePage = options.ansiCodePage;
+        const bool useBuildCache = options.useBuildCache;
+        const bool writeIndex = options.writeIndex;
+
+        if (GetFileExtension(GXTName).empty())
+        {
+            GXTName += L".gxt";
+        }
+
+        if (options.watch)
+        {
+            try
+            {
+                Diagnostics.Open(GetPathNoExtension(GXTName) + L"_replace.log", options.logFormat, options.logLevel);
+                if (writeIndex)
+                {
+                    GXTIndex::Build(GXTName, fileVersion);
+                }
+
+                const TextConverter textConverter(textConvMode, ansiCodePage);
+                GXTWatcher watcher(GXTName, fileVersion, TextDirectoryToReplace, textConverter, Diagnostics);
+                watcher.Run();
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+            return 0;
+        }
+
+        if (options.plan)
+        {
+            try
+            {
+                auto gxt = ReadGXTFile(GXTName, fileVersion);
+                Diagnostics.Open(GetPathNoExtension(GXTName) + L"_replace.log", options.logFormat, options.logLevel);
+
+                const TextConverter textConverter(textConvMode, ansiCodePage);
+                PrintPlan(gxt->PlanReplaceText(TextDirectoryToReplace, textConverter, Diagnostics), std::filesystem::file_size(Platform::ToPath(GXTName)));
+                Diagnostics.PrintSummary(std::cout);
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "ERROR: " << e.what();
+                return 1;
+            }
+            return 0;
+        }
+
+        const bool reportStats = options.stats || !options.statsJsonFileName.empty();
+#ifdef GXT_ENABLE_STATS
+        if (reportStats)
+        {
+            BuildStats::Enable();
+        }
+        if (!options.traceFileName.empty())
+        {
+            BuildTrace::Enable();
+        }
+#else
+        if (reportStats || !options.traceFileName.empty())
+        {
+            std::cerr << "WARNING: This build was compiled without GXT_ENABLE_STATS, so there are no stats or trace to report!\n";
+        }
+#endif
+
+        try
+        {
+            GXT_STATS_TIMER(PhaseOther);
+            std::optional<BuildCache> buildCache;
+            if (useBuildCache)
+            {
+                buildCache.emplace(GetPathNoExtension(GXTName) + L"_replace.cache", TextDirectoryToReplace, fileVersion, textConvMode, ansiCodePage);
+                buildCache->Load();
+            }
+
+            auto gxt = ReadGXTFile(GXTName, fileVersion, buildCache ? &buildCache.value() : nullptr);
+            Diagnostics.Open(GetPathNoExtension(GXTName) + L"_replace.log", options.logFormat, options.logLevel);
+            gxt->BulkReplaceText(TextDirectoryToReplace, textConvMode, ansiCodePage, Diagnostics, buildCache ? &buildCache.value() : nullptr);
+
+            if (!options.budgetFileName.empty() && !SizeBudget::Load(options.budgetFileName).Check(*gxt, std::cout))
+            {
+                throw std::runtime_error("The size budget is exceeded, the GXT file wasn't written!");
+            }
+
+            gxt->WriteGXTFile(GXTName);
+
+            // A stale index would be rejected anyway, so refresh it while the new file is in the page cache
+            if (writeIndex || std::filesystem::exists(Platform::ToPath(GXTIndex::GetIndexFileName(GXTName))))
+            {
+                GXTIndex::Build(GXTName, fileVersion);
+            }
+
+            if (buildCache)
+            {
+                buildCache->Update(*gxt, Diagnostics);
+                buildCache->Save();
+            }
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "ERROR: " << e.what();
+            return 1;
+        }
+
+        Diagnostics.PrintSummary(std::cout);
+
+        if (BuildStats::IsEnabled())
+        {
+            if (options.stats)
+            {
+                BuildStats::PrintReport(std::cout);
+            }
+            if (!options.statsJsonFileName.empty())
+            {
+                std::ofstream statsFile(Platform::ToPath(options.statsJsonFileName));
+                BuildStats::WriteJson(statsFile);
+            }
+        }
+        if (BuildTrace::IsEnabled())
+        {
+            std::ofstream traceFile(Platform::ToPath(options.traceFileName));
+            BuildTrace::Write(traceFile);
+        }
+
+        return 0;
+    }
+    else
+    {
+        std::cout << helpText;
+        return 0;
+    }
+
+    return 0;
+}
\ No newline at end of file
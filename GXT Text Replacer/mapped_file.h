@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+// Read-only view of a whole file mapped into memory (mapped_file_win32.cpp and mapped_file_posix.cpp)
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::wstring& fileName);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* GetData() const
+    {
+        return _data;
+    }
+    size_t GetSize() const
+    {
+        return _size;
+    }
+
+private:
+#ifdef _WIN32
+    void*			_fileHandle = nullptr;
+    void*			_mappingHandle = nullptr;
+#endif
+    const char*		_data = nullptr;
+    size_t			_size = 0;
+};
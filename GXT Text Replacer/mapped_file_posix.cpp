@@ -0,0 +1,50 @@
+#include "mapped_file.h"
+#include "platform.h"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile(const std::wstring& fileName)
+{
+    const int fileDescriptor = open(Platform::ToPath(fileName).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor == -1)
+    {
+        throw std::runtime_error("Can't open " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0)
+    {
+        close(fileDescriptor);
+        throw std::runtime_error("Can't get the size of " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+    _size = static_cast<size_t>(fileStatus.st_size);
+
+    // Empty files can't be mapped
+    if (_size == 0)
+    {
+        close(fileDescriptor);
+        return;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error("Can't map " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+    _data = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data != nullptr)
+    {
+        munmap(const_cast<char*>(_data), _size);
+    }
+}
@@ -0,0 +1,62 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+MappedFile::MappedFile(const std::wstring& fileName)
+{
+    HANDLE fileHandle = CreateFileW(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Can't open " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+    _fileHandle = fileHandle;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        CloseHandle(fileHandle);
+        throw std::runtime_error("Can't get the size of " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+    _size = static_cast<size_t>(fileSize.QuadPart);
+
+    // Empty files can't be mapped
+    if (_size == 0)
+    {
+        return;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+    {
+        CloseHandle(fileHandle);
+        throw std::runtime_error("Can't map " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+    _mappingHandle = mappingHandle;
+
+    _data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (_data == nullptr)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        throw std::runtime_error("Can't map " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (_data != nullptr)
+    {
+        UnmapViewOfFile(_data);
+    }
+    if (_mappingHandle != nullptr)
+    {
+        CloseHandle(_mappingHandle);
+    }
+    if (_fileHandle != nullptr)
+    {
+        CloseHandle(_fileHandle);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+
+class Parallel
+{
+public:
+    // Runs task(index) for every index in [0, count) on up to one thread per core, the calling thread included.
+    // Every thread takes the next index until none are left, so large and small tasks even out. The first exception
+    // thrown by a task is rethrown once all threads finished.
+    // The started threads come from one budget for the whole process, so a task calling ForEachIndex again only
+    // gets the cores the outer call left idle and runs on its own thread once they are all taken.
+    template<typename Task>
+    static void ForEachIndex(size_t count, const Task& task)
+    {
+        std::atomic<size_t> nextIndex{ 0 };
+        std::mutex errorMutex;
+        std::exception_ptr error;
+
+        auto worker = [&]()
+        {
+            for (size_t i = nextIndex++; i < count; i = nextIndex++)
+            {
+                try
+                {
+                    task(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        const size_t extraThreadCount = AcquireThreads(count > 0 ? count - 1 : 0);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < extraThreadCount; i++)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        ReleaseThreads(extraThreadCount);
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    // Threads that may run next to the main thread, one per core beyond the first
+    static std::atomic<size_t>& GetIdleThreadCount()
+    {
+        static std::atomic<size_t> idleThreadCount{ static_cast<size_t>((std::max)(std::thread::hardware_concurrency(), 1u)) - 1 };
+        return idleThreadCount;
+    }
+
+    // Takes up to wanted threads from the budget and returns how many it got
+    static size_t AcquireThreads(size_t wanted)
+    {
+        std::atomic<size_t>& idleThreadCount = GetIdleThreadCount();
+        size_t idle = idleThreadCount.load();
+        size_t taken;
+        do
+        {
+            taken = (std::min)(idle, wanted);
+        }
+        while (!idleThreadCount.compare_exchange_weak(idle, idle - taken));
+        return taken;
+    }
+
+    static void ReleaseThreads(size_t count)
+    {
+        GetIdleThreadCount() += count;
+    }
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <filesystem>
+#include <cstdint>
+
+// The entry point takes the command line in the native character type, see Platform::GetArguments
+#ifdef _WIN32
+#define PLATFORM_MAIN wmain
+typedef wchar_t		native_char_t;
+#else
+#define PLATFORM_MAIN main
+typedef char		native_char_t;
+#endif
+
+// Operating system services: paths, code page conversion, the console and the command line.
+// platform_win32.cpp implements them with the Win32 API and platform_posix.cpp with POSIX and iconv.
+// File names are kept in std::wstring everywhere else and only converted here.
+class Platform
+{
+public:
+    static constexpr int		CODE_PAGE_UTF8 = 65001;
+#ifdef _WIN32
+    static constexpr wchar_t	PATH_SEPARATOR = L'\\';
+#else
+    static constexpr wchar_t	PATH_SEPARATOR = L'/';
+#endif
+
+    // File names are UTF-8 on POSIX systems
+    static std::filesystem::path	ToPath(const std::wstring& fileName);
+    static std::wstring				FromPath(const std::filesystem::path& path);
+
+    // The ANSI code page of the system on Windows. Other systems have none, so Windows-1252 is used unless
+    // -ansicodepage is given, which keeps builds identical across machines.
+    static int			GetAnsiCodePage();
+    // Characters that can't be converted become U+FFFD and '?' respectively, like with the Win32 API
+    static std::wstring	ToWide(std::string_view text, int codePage);
+    static std::string	FromWide(const std::wstring& text, int codePage);
+
+    // Makes std::wcout and std::wcerr print file names and keeps their output in order with std::cout
+    static void			InitializeConsole();
+    static std::vector<std::wstring>	GetArguments(int argc, native_char_t* argv[]);
+
+    // The usable size of a block returned by malloc, which may be larger than the requested size
+    static size_t		GetAllocationSize(void* memory);
+    // The largest resident set (working set on Windows) of the process so far
+    static uint64_t		GetPeakResidentBytes();
+};
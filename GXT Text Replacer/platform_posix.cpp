@@ -0,0 +1,195 @@
+#include "platform.h"
+
+#include <map>
+#include <locale>
+#include <codecvt>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+
+#include <iconv.h>
+#include <malloc.h>
+#include <sys/resource.h>
+
+namespace
+{
+    // iconv name of a Windows code page
+    std::string GetCharsetName(int codePage)
+    {
+        if (codePage == Platform::CODE_PAGE_UTF8)
+        {
+            return "UTF-8";
+        }
+        if (codePage == 20127)
+        {
+            return "ASCII";
+        }
+        if (codePage >= 28591 && codePage <= 28599)
+        {
+            return "ISO-8859-" + std::to_string(codePage - 28590);
+        }
+        return "CP" + std::to_string(codePage);
+    }
+
+    // Conversion descriptors are opened once per thread and code page, entry texts are converted one by one
+    class IconvCache
+    {
+    public:
+        ~IconvCache()
+        {
+            for (const auto& pair : _descriptors)
+            {
+                iconv_close(pair.second);
+            }
+        }
+
+        iconv_t Get(int codePage, bool toWide)
+        {
+            auto itr = _descriptors.find(std::make_pair(codePage, toWide));
+            if (itr != _descriptors.end())
+            {
+                return itr->second;
+            }
+
+            const std::string charsetName = GetCharsetName(codePage);
+            iconv_t descriptor = toWide ? iconv_open("WCHAR_T", charsetName.c_str()) : iconv_open(charsetName.c_str(), "WCHAR_T");
+            if (descriptor == reinterpret_cast<iconv_t>(-1))
+            {
+                throw std::runtime_error("The code page " + std::to_string(codePage) + " isn't supported!");
+            }
+
+            _descriptors.emplace(std::make_pair(codePage, toWide), descriptor);
+            return descriptor;
+        }
+
+    private:
+        std::map<std::pair<int, bool>, iconv_t>	_descriptors;
+    };
+
+    thread_local IconvCache iconvCache;
+
+    // Converts size bytes of input. Input units that can't be converted are skipped and replaced with replacement.
+    std::string Convert(iconv_t descriptor, const char* input, size_t size, size_t inputUnitSize, const std::string& replacement)
+    {
+        // Reset the shift state left by a previous call
+        iconv(descriptor, nullptr, nullptr, nullptr, nullptr);
+
+        std::string output;
+        output.resize(size * 4 + 16);
+
+        char* inputPtr = const_cast<char*>(input);
+        size_t inputLeft = size;
+        size_t outputUsed = 0;
+
+        while (inputLeft > 0)
+        {
+            char* outputPtr = &output[outputUsed];
+            size_t outputLeft = output.size() - outputUsed;
+
+            const size_t result = iconv(descriptor, &inputPtr, &inputLeft, &outputPtr, &outputLeft);
+            outputUsed = output.size() - outputLeft;
+
+            if (result != static_cast<size_t>(-1))
+            {
+                break;
+            }
+
+            if (errno == E2BIG)
+            {
+                output.resize(output.size() * 2);
+            }
+            else
+            {
+                // EILSEQ or EINVAL
+                const size_t skippedSize = (std::min)(inputUnitSize, inputLeft);
+                inputPtr += skippedSize;
+                inputLeft -= skippedSize;
+
+                output.resize((std::max)(output.size(), outputUsed + replacement.size() + inputLeft * 4 + 16));
+                output.replace(outputUsed, replacement.size(), replacement);
+                outputUsed += replacement.size();
+            }
+        }
+
+        output.resize(outputUsed);
+        return output;
+    }
+}
+
+std::filesystem::path Platform::ToPath(const std::wstring& fileName)
+{
+    return std::filesystem::path(FromWide(fileName, CODE_PAGE_UTF8));
+}
+
+std::wstring Platform::FromPath(const std::filesystem::path& path)
+{
+    return ToWide(path.native(), CODE_PAGE_UTF8);
+}
+
+int Platform::GetAnsiCodePage()
+{
+    return 1252;
+}
+
+std::wstring Platform::ToWide(std::string_view text, int codePage)
+{
+    if (text.empty())
+    {
+        return std::wstring();
+    }
+
+    const wchar_t replacementCharacter = 0xFFFD;
+    const std::string wideBytes = Convert(iconvCache.Get(codePage, true), text.data(), text.size(), 1,
+        std::string(reinterpret_cast<const char*>(&replacementCharacter), sizeof(replacementCharacter)));
+
+    return std::wstring(reinterpret_cast<const wchar_t*>(wideBytes.data()), wideBytes.size() / sizeof(wchar_t));
+}
+
+std::string Platform::FromWide(const std::wstring& text, int codePage)
+{
+    if (text.empty())
+    {
+        return std::string();
+    }
+
+    return Convert(iconvCache.Get(codePage, false), reinterpret_cast<const char*>(text.data()), text.size() * sizeof(wchar_t), sizeof(wchar_t), "?");
+}
+
+void Platform::InitializeConsole()
+{
+    // Wide output would otherwise only print ASCII, and without stdio synchronization every stream has its own buffer
+    const std::locale utf8Locale(std::locale(), new std::codecvt_utf8<wchar_t>);
+    std::wcout.imbue(utf8Locale);
+    std::wcerr.imbue(utf8Locale);
+
+    std::cout << std::unitbuf;
+    std::wcout << std::unitbuf;
+}
+
+std::vector<std::wstring> Platform::GetArguments(int argc, native_char_t* argv[])
+{
+    std::vector<std::wstring> arguments;
+    arguments.reserve(argc);
+    for (int i = 0; i < argc; i++)
+    {
+        arguments.push_back(ToWide(argv[i], CODE_PAGE_UTF8));
+    }
+    return arguments;
+}
+
+size_t Platform::GetAllocationSize(void* memory)
+{
+    return malloc_usable_size(memory);
+}
+
+uint64_t Platform::GetPeakResidentBytes()
+{
+    // ru_maxrss is in kilobytes on Linux
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+}
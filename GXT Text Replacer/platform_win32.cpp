@@ -0,0 +1,76 @@
+#include "platform.h"
+
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#include <malloc.h>
+
+std::filesystem::path Platform::ToPath(const std::wstring& fileName)
+{
+    return std::filesystem::path(fileName);
+}
+
+std::wstring Platform::FromPath(const std::filesystem::path& path)
+{
+    return path.wstring();
+}
+
+int Platform::GetAnsiCodePage()
+{
+    return GetACP();
+}
+
+std::wstring Platform::ToWide(std::string_view text, int codePage)
+{
+    if (text.empty())
+    {
+        return std::wstring();
+    }
+
+    const int length = MultiByteToWideChar(codePage, 0, text.data(), static_cast<int>(text.size()), nullptr, 0);
+    std::wstring wideText(length, L'\0');
+    MultiByteToWideChar(codePage, 0, text.data(), static_cast<int>(text.size()), &wideText[0], length);
+
+    return wideText;
+}
+
+std::string Platform::FromWide(const std::wstring& text, int codePage)
+{
+    if (text.empty())
+    {
+        return std::string();
+    }
+
+    const int length = WideCharToMultiByte(codePage, 0, text.data(), static_cast<int>(text.size()), nullptr, 0, nullptr, nullptr);
+    std::string narrowText(length, '\0');
+    WideCharToMultiByte(codePage, 0, text.data(), static_cast<int>(text.size()), &narrowText[0], length, nullptr, nullptr);
+
+    return narrowText;
+}
+
+void Platform::InitializeConsole()
+{
+    // The CRT converts wide console output with the locale set by setlocale
+}
+
+std::vector<std::wstring> Platform::GetArguments(int argc, native_char_t* argv[])
+{
+    return std::vector<std::wstring>(argv, argv + argc);
+}
+
+size_t Platform::GetAllocationSize(void* memory)
+{
+    return _msize(memory);
+}
+
+uint64_t Platform::GetPeakResidentBytes()
+{
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <type_traits>
+#include <cstdint>
+
+// LSD radix sort on an unsigned integer key returned by getKey, one byte per pass. The sort is stable,
+// so items with equal keys keep their order. Passes where every item has the same byte are skipped,
+// which makes small TDAT offsets sort in two or three passes instead of four.
+template<typename T, typename KeyFunc>
+void RadixSort(std::vector<T>& items, KeyFunc getKey)
+{
+    typedef decltype(getKey(items.front())) radix_t;
+    static_assert(std::is_unsigned<radix_t>::value, "The radix key must be an unsigned integer");
+
+    constexpr size_t PASS_COUNT = sizeof(radix_t);
+    constexpr size_t BUCKET_COUNT = 256;
+
+    if (items.size() < 2)
+    {
+        return;
+    }
+
+    // The histograms of every pass are counted in one go
+    std::array<std::array<size_t, BUCKET_COUNT>, PASS_COUNT> histograms = {};
+    for (const auto& item : items)
+    {
+        const radix_t key = getKey(item);
+        for (size_t pass = 0; pass < PASS_COUNT; pass++)
+        {
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+        }
+    }
+
+    std::vector<T> scratch(items.size());
+    for (size_t pass = 0; pass < PASS_COUNT; pass++)
+    {
+        auto& histogram = histograms[pass];
+        if (histogram[(getKey(items.front()) >> (pass * 8)) & 0xFF] == items.size())
+        {
+            continue;
+        }
+
+        size_t position = 0;
+        for (auto& count : histogram)
+        {
+            const size_t bucketSize = count;
+            count = position;
+            position += bucketSize;
+        }
+
+        for (auto& item : items)
+        {
+            scratch[histogram[(getKey(item) >> (pass * 8)) & 0xFF]++] = std::move(item);
+        }
+        items.swap(scratch);
+    }
+}
@@ -0,0 +1,154 @@
+#include "size_budget.h"
+#include "gxt_text_replacer.h"
+#include "platform.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+SizeBudget SizeBudget::Load(const std::wstring& fileName)
+{
+    std::ifstream budgetFile(Platform::ToPath(fileName), std::ifstream::in);
+    if (!budgetFile.is_open())
+    {
+        throw std::runtime_error("Can't open the budget file " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+
+    SizeBudget sizeBudget;
+
+    uint64_t lineCount = 0;
+    std::string fileLine;
+    while (std::getline(budgetFile, fileLine))
+    {
+        lineCount++;
+
+        if (!fileLine.empty() && fileLine.back() == '\r')
+        {
+            fileLine.pop_back();
+        }
+        if (fileLine.empty() || fileLine[0] == '#')
+        {
+            continue;
+        }
+
+        const std::string::size_type tabPos = fileLine.find_first_of('\t');
+        size_t parsedLength = 0;
+        uint64_t budget = 0;
+        try
+        {
+            if (tabPos != std::string::npos)
+            {
+                budget = std::stoull(fileLine.substr(tabPos + 1), &parsedLength);
+            }
+        }
+        catch (std::exception&)
+        {
+            parsedLength = 0;
+        }
+
+        if (tabPos == std::string::npos || tabPos == 0 || parsedLength == 0 || tabPos + 1 + parsedLength != fileLine.size())
+        {
+            throw std::runtime_error("Invalid budget in line " + std::to_string(lineCount) + " of " + std::string(fileName.begin(), fileName.end()) + "!");
+        }
+
+        std::string name = fileLine.substr(0, tabPos);
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+
+        if (name == "*")
+        {
+            sizeBudget._missionTableBudget = budget;
+        }
+        else if (name == "@FILE")
+        {
+            sizeBudget._fileBudget = budget;
+        }
+        else if (name == "@WARN")
+        {
+            if (budget > 100)
+            {
+                throw std::runtime_error("The warning threshold in line " + std::to_string(lineCount) + " of " + std::string(fileName.begin(), fileName.end()) + " is over 100 percent!");
+            }
+            sizeBudget._warningPercent = budget;
+        }
+        else
+        {
+            sizeBudget._tableBudgets[FixedName8(name)] = budget;
+        }
+    }
+
+    return sizeBudget;
+}
+
+std::optional<uint64_t> SizeBudget::FindTableBudget(const FixedName8& tableName, bool isMainTable) const
+{
+    auto itr = _tableBudgets.find(tableName);
+    if (itr != _tableBudgets.end())
+    {
+        return itr->second;
+    }
+    return isMainTable ? std::nullopt : _missionTableBudget;
+}
+
+bool SizeBudget::Check(GXTTableCollection& tableCollection, std::ostream& report) const
+{
+    bool withinBudget = true;
+
+    // Returns true if the size reached the warning threshold of the budget
+    auto reportSize = [&](const std::string& name, uint64_t size, const std::optional<uint64_t>& budget)
+    {
+        report << std::left << std::setw(10) << name << std::right << std::setw(12) << size;
+        if (budget)
+        {
+            report << std::setw(12) << budget.value() << std::setw(12) << static_cast<int64_t>(budget.value() - size);
+        }
+        else
+        {
+            report << std::setw(12) << "-" << std::setw(12) << "-";
+        }
+
+        const bool exceeded = budget && size > budget.value();
+        const bool warned = budget && size * 100 >= budget.value() * _warningPercent;
+        report << (exceeded ? "  EXCEEDED" : warned ? "  WARNING" : "") << "\n";
+        withinBudget = withinBudget && !exceeded;
+        return warned;
+    };
+
+    auto checkTable = [&](GXTTableBlockInfo& tableInfo, bool isMainTable)
+    {
+        const std::string tableName = tableInfo._tableName.ToString();
+        if (!reportSize(tableName, tableInfo.GetBlockSize(), FindTableBudget(tableInfo._tableName, isMainTable)))
+        {
+            return;
+        }
+
+        // Tables spliced from the build cache weren't parsed, so the cached block is parsed into an empty copy here
+        const GXTTableBase* table = tableInfo._GXTTable.get();
+        std::unique_ptr<GXTTableBase> splicedTable;
+        if (tableInfo.IsSpliced())
+        {
+            splicedTable = tableInfo._GXTTable->Clone();
+            std::istringstream blockStream(tableInfo._splicedBlock);
+            splicedTable->ReadTKEYAndTDATBlock(blockStream, 0);
+            table = splicedTable.get();
+        }
+
+        for (const auto& entry : table->GetLargestEntries(REPORTED_ENTRY_COUNT))
+        {
+            report << "    " << std::left << std::setw(14) << entry.first << std::right << std::setw(8) << entry.second << " bytes\n";
+        }
+    };
+
+    report << std::left << std::setw(10) << "Table" << std::right << std::setw(12) << "Size" << std::setw(12) << "Budget" << std::setw(12) << "Headroom" << "\n";
+
+    checkTable(tableCollection.GetMainTable(), true);
+    for (auto& missionTable : tableCollection.GetMissionTableMap())
+    {
+        checkTable(*missionTable.second, false);
+    }
+
+    reportSize("File", tableCollection.ComputeFileSize(), _fileBudget);
+
+    return withinBudget;
+}
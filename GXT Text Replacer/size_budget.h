@@ -0,0 +1,36 @@
+#pragma once
+
+#include "fixed_name.h"
+
+#include <string>
+#include <map>
+#include <optional>
+#include <ostream>
+
+class GXTTableCollection;
+
+// Byte budgets of the TKEY and TDAT blocks of tables and of the whole GXT file. SA loads a mission table into a fixed-size
+// buffer, so a translated table that outgrows it corrupts memory in-game.
+// The budget file has one "[Table name]\t[bytes]" line per table. "*" sets the budget of every mission table without
+// its own line and "@FILE" the budget of the whole file. "@WARN" sets the share of a budget in percent from which a table
+// is reported as close to it, 90 by default. Lines starting with '#' are comments.
+class SizeBudget
+{
+public:
+    static SizeBudget Load(const std::wstring& fileName);
+
+    // Reports the size, budget and headroom of every table and the largest entries of the tables over the warning
+    // threshold of their budget. Returns false if any budget is exceeded.
+    bool Check(GXTTableCollection& tableCollection, std::ostream& report) const;
+
+private:
+    static constexpr size_t		REPORTED_ENTRY_COUNT = 5;
+    static constexpr uint64_t	DEFAULT_WARNING_PERCENT = 90;
+
+    std::optional<uint64_t> FindTableBudget(const FixedName8& tableName, bool isMainTable) const;
+
+    std::map<FixedName8, uint64_t>	_tableBudgets;
+    std::optional<uint64_t>			_missionTableBudget;
+    std::optional<uint64_t>			_fileBudget;
+    uint64_t						_warningPercent = DEFAULT_WARNING_PERCENT;
+};
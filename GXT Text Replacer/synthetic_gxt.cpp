@@ -0,0 +1,325 @@
+#include "synthetic_gxt.h"
+#include "fixed_name.h"
+#include "crc32keygen.h"
+#include "utility.h"
+#include "platform.h"
+#include "utf8.h"
+
+#include <vector>
+#include <fstream>
+#include <random>
+#include <iterator>
+#include <algorithm>
+#include <unordered_set>
+#include <stdexcept>
+
+namespace
+{
+    // The distributions of the standard library differ between implementations, so numbers are derived from
+    // std::mt19937 directly to generate the same files everywhere
+    class Random
+    {
+    public:
+        explicit Random(uint32_t seed)
+            : _engine(seed)
+        {}
+
+        // Uniform in [0, bound)
+        uint32_t Next(uint32_t bound)
+        {
+            return static_cast<uint32_t>((static_cast<uint64_t>(_engine()) * bound) >> 32);
+        }
+
+        // Uniform in [0, 1)
+        double NextDouble()
+        {
+            return _engine() / 4294967296.0;
+        }
+
+    private:
+        std::mt19937	_engine;
+    };
+
+    const char		ASCII_CHARACTERS[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 .,!?'-";
+    const uint32_t	LATIN1_FIRST_LETTER = 0xC0;
+    const uint32_t	LATIN1_LETTER_COUNT = 0x40;
+    const uint32_t	CJK_FIRST_IDEOGRAPH = 0x4E00;
+    const uint32_t	CJK_IDEOGRAPH_COUNT = 0x80;
+    // The character map starts with U+0020-U+007F, the ideographs or U+00A0-U+011F follow
+    const uint32_t	CHARACTER_MAP_ASCII_SLOTS = 0x60;
+
+    uint32_t GetCharacterMapCodePoint(SyntheticGXTSettings::eAlphabet alphabet, size_t slot)
+    {
+        if (slot < CHARACTER_MAP_ASCII_SLOTS)
+        {
+            return static_cast<uint32_t>(0x20 + slot);
+        }
+        const uint32_t firstCodePoint = alphabet == SyntheticGXTSettings::AlphabetCJK ? CJK_FIRST_IDEOGRAPH : 0xA0;
+        return static_cast<uint32_t>(firstCodePoint + slot - CHARACTER_MAP_ASCII_SLOTS);
+    }
+
+    std::vector<uint32_t> MakeText(Random& random, const SyntheticGXTSettings& settings)
+    {
+        const size_t lengthRange = settings.maxTextLength - settings.minTextLength;
+        double lengthFraction = random.NextDouble();
+        if (settings.skewedTextLength)
+        {
+            lengthFraction = lengthFraction * lengthFraction * lengthFraction;
+        }
+        const size_t length = settings.minTextLength + static_cast<size_t>(lengthFraction * (lengthRange + 1));
+
+        std::vector<uint32_t> text;
+        text.reserve(length);
+        for (size_t i = 0; i < length; i++)
+        {
+            if (settings.alphabet == SyntheticGXTSettings::AlphabetLatin1 && i % 4 == 3)
+            {
+                text.push_back(LATIN1_FIRST_LETTER + random.Next(LATIN1_LETTER_COUNT));
+            }
+            else if (settings.alphabet == SyntheticGXTSettings::AlphabetCJK && random.Next(4) != 0)
+            {
+                text.push_back(CJK_FIRST_IDEOGRAPH + random.Next(CJK_IDEOGRAPH_COUNT));
+            }
+            else
+            {
+                text.push_back(static_cast<unsigned char>(ASCII_CHARACTERS[random.Next(sizeof(ASCII_CHARACTERS) - 1)]));
+            }
+        }
+        return text;
+    }
+
+    // TDAT bytes of the text including the terminator. 8-bit tables get Windows-1252 bytes for Latin-1 letters and
+    // character map bytes for ideographs, like the replacer would write them with -ansitext and -usecharmap.
+    void AppendTableText(std::string& tdat, const std::vector<uint32_t>& text, bool is16Bit)
+    {
+        for (uint32_t codePoint : text)
+        {
+            if (is16Bit)
+            {
+                const uint16_t character = static_cast<uint16_t>(codePoint);
+                tdat.append(reinterpret_cast<const char*>(&character), sizeof(character));
+            }
+            else if (codePoint >= CJK_FIRST_IDEOGRAPH)
+            {
+                tdat.push_back(static_cast<char>(0x20 + CHARACTER_MAP_ASCII_SLOTS + codePoint - CJK_FIRST_IDEOGRAPH));
+            }
+            else
+            {
+                tdat.push_back(static_cast<char>(codePoint));
+            }
+        }
+        tdat.append(is16Bit ? 2 : 1, '\0');
+    }
+
+    std::string ToUtf8(const std::vector<uint32_t>& text)
+    {
+        std::string utf8Text;
+        for (uint32_t codePoint : text)
+        {
+            utf8::append(codePoint, std::back_inserter(utf8Text));
+        }
+        return utf8Text;
+    }
+
+    void AppendUInt32(std::string& buffer, uint32_t value)
+    {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    std::string MakeTableName(size_t tableIndex)
+    {
+        if (tableIndex == 0)
+        {
+            return "MAIN";
+        }
+        std::string number = std::to_string(tableIndex);
+        return "MIS" + std::string(4 - number.size(), '0') + number;
+    }
+
+    std::string MakeEntryName(size_t entryIndex)
+    {
+        static const char hexDigits[] = "0123456789ABCDEF";
+
+        std::string name = "E000000";
+        for (size_t i = name.size() - 1; i > 0; i--, entryIndex >>= 4)
+        {
+            name[i] = hexDigits[entryIndex & 0xF];
+        }
+        return name;
+    }
+
+    struct GeneratedEntry
+    {
+        std::string		name;
+        uint32_t		hash;
+    };
+
+    // Returns the TKEY and TDAT blocks of the table and appends the replacing lines to textLines
+    std::string GenerateTable(const SyntheticGXTSettings& settings, size_t& nextEntryIndex, Random& tableRandom, Random& textRandom,
+        std::string& textLines, size_t& replacedCount)
+    {
+        const bool usesHash = settings.fileVersion != GXTEnum::eGXTVersion::GXT_VC;
+        const bool is16Bit = settings.fileVersion == GXTEnum::eGXTVersion::GXT_VC || settings.fileVersion == GXTEnum::eGXTVersion::GXT_SA_16BIT;
+
+        // Names whose hash collides with an earlier one of the table are skipped
+        std::vector<GeneratedEntry> entries;
+        std::unordered_set<uint32_t> usedHashes;
+        entries.reserve(settings.entriesPerTable);
+        while (entries.size() < settings.entriesPerTable)
+        {
+            if (nextEntryIndex >= SyntheticGXT::MAX_ENTRY_COUNT)
+            {
+                throw std::runtime_error("Too many entries to generate, at most " + std::to_string(SyntheticGXT::MAX_ENTRY_COUNT) + " are supported!");
+            }
+
+            GeneratedEntry entry;
+            entry.name = MakeEntryName(nextEntryIndex++);
+            entry.hash = usesHash ? Crc32KeyGen::GetUppercaseKey(entry.name.c_str()) : 0;
+            if (!usesHash || usedHashes.insert(entry.hash).second)
+            {
+                entries.push_back(std::move(entry));
+            }
+        }
+
+        // SA looks entries up by binary search over the hashes and VC over the names, which are generated in order
+        if (usesHash)
+        {
+            std::sort(entries.begin(), entries.end(), [](const GeneratedEntry& lhs, const GeneratedEntry& rhs) { return lhs.hash < rhs.hash; });
+        }
+
+        std::string tkey;
+        std::string tdat;
+        std::vector<uint32_t> offsets;
+        offsets.reserve(entries.size());
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (i > 0 && tableRandom.NextDouble() < settings.sharedOffsetRatio)
+            {
+                offsets.push_back(offsets[tableRandom.Next(static_cast<uint32_t>(i))]);
+            }
+            else
+            {
+                offsets.push_back(static_cast<uint32_t>(tdat.size()));
+                AppendTableText(tdat, MakeText(tableRandom, settings), is16Bit);
+            }
+
+            AppendUInt32(tkey, offsets.back());
+            if (usesHash)
+            {
+                AppendUInt32(tkey, entries[i].hash);
+            }
+            else
+            {
+                tkey.append(FixedName8(entries[i].name).ToBytes().data(), FixedName8::SIZE);
+            }
+
+            if (textRandom.NextDouble() < settings.replacedRatio)
+            {
+                textLines += entries[i].name + "\t" + ToUtf8(MakeText(textRandom, settings)) + "\n";
+                replacedCount++;
+            }
+        }
+
+        std::string block = "TKEY";
+        AppendUInt32(block, static_cast<uint32_t>(tkey.size()));
+        block += tkey;
+        block += "TDAT";
+        AppendUInt32(block, static_cast<uint32_t>(tdat.size()));
+        block += tdat;
+        return block;
+    }
+
+    void WriteFile(const std::wstring& fileName, const std::string& content)
+    {
+        std::ofstream file(Platform::ToPath(fileName), std::ofstream::binary);
+        file.write(content.data(), content.size());
+        if (!file)
+        {
+            throw std::runtime_error("Can't write " + std::string(fileName.begin(), fileName.end()) + "!");
+        }
+    }
+}
+
+size_t SyntheticGXT::Generate(const SyntheticGXTSettings& settings, const std::wstring& gxtFileName, const std::wstring& textDirectory)
+{
+    namespace fs = std::filesystem;
+
+    if (settings.missionTableCount > MAX_MISSION_TABLE_COUNT)
+    {
+        throw std::runtime_error("Too many mission tables to generate, at most " + std::to_string(MAX_MISSION_TABLE_COUNT) + " are supported!");
+    }
+    if (settings.minTextLength > settings.maxTextLength)
+    {
+        throw std::runtime_error("The minimum text length is larger than the maximum one!");
+    }
+    if (settings.fileVersion == GXTEnum::eGXTVersion::GXT_SA_MOBILE)
+    {
+        throw std::runtime_error("Mobile GXT files can't be generated!");
+    }
+
+    // Texts for the text folder come from their own sequence, so the GXT file doesn't depend on the replaced ratio
+    Random tableRandom(settings.seed);
+    Random textRandom(settings.seed ^ 0x9E3779B9);
+
+    const size_t tableCount = settings.missionTableCount + 1;
+    size_t nextEntryIndex = 0;
+    size_t replacedCount = 0;
+    std::vector<std::string> tableBlocks;
+
+    for (size_t i = 0; i < tableCount; i++)
+    {
+        std::string textLines;
+        tableBlocks.push_back(GenerateTable(settings, nextEntryIndex, tableRandom, textRandom, textLines, replacedCount));
+
+        if (!textLines.empty())
+        {
+            const std::wstring tableDirectory = textDirectory + Platform::PATH_SEPARATOR + Encoding::AnsiStringToWString(MakeTableName(i));
+            fs::create_directories(Platform::ToPath(tableDirectory));
+            WriteFile(tableDirectory + Platform::PATH_SEPARATOR + L"generated.txt", textLines);
+        }
+    }
+
+    // Mission tables are preceded by their names, every table but the last one is padded to 4 bytes
+    std::string file;
+    if (settings.fileVersion != GXTEnum::eGXTVersion::GXT_VC)
+    {
+        AppendUInt32(file, settings.fileVersion == GXTEnum::eGXTVersion::GXT_SA_16BIT ? 0x100004 : 0x080004);
+    }
+    file += "TABL";
+    AppendUInt32(file, static_cast<uint32_t>(tableCount * 12));
+
+    size_t tableOffset = file.size() + tableCount * 12;
+    for (size_t i = 0; i < tableCount; i++)
+    {
+        file.append(FixedName8(MakeTableName(i)).ToBytes().data(), FixedName8::SIZE);
+        AppendUInt32(file, static_cast<uint32_t>(tableOffset));
+        tableOffset = (tableOffset + (i == 0 ? 0 : FixedName8::SIZE) + tableBlocks[i].size() + 3) & ~static_cast<size_t>(3);
+    }
+    for (size_t i = 0; i < tableCount; i++)
+    {
+        if (i != 0)
+        {
+            file.append(FixedName8(MakeTableName(i)).ToBytes().data(), FixedName8::SIZE);
+        }
+        file += tableBlocks[i];
+        if (i + 1 != tableCount)
+        {
+            file.resize((file.size() + 3) & ~static_cast<size_t>(3), '\0');
+        }
+    }
+    WriteFile(gxtFileName, file);
+
+    std::string characterMap;
+    for (size_t slot = 0; slot < CHARACTER_MAP_SIZE; slot++)
+    {
+        utf8::append(GetCharacterMapCodePoint(settings.alphabet, slot), std::back_inserter(characterMap));
+        if (slot % CHARACTER_MAP_WIDTH == CHARACTER_MAP_WIDTH - 1)
+        {
+            characterMap += "\n";
+        }
+    }
+    const fs::path charMapPath = Platform::ToPath(gxtFileName).parent_path() / "charmap.txt";
+    WriteFile(Platform::FromPath(charMapPath), characterMap);
+
+    return replacedCount;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "enum.h"
+
+#include <string>
+#include <cstdint>
+
+struct SyntheticGXTSettings
+{
+    enum eAlphabet
+    {
+        // Letters, digits and punctuation
+        AlphabetAscii,
+        // ASCII with every fourth character from U+00C0-U+00FF
+        AlphabetLatin1,
+        // Mostly CJK ideographs from U+4E00-U+4E7F, 8-bit SA tables store them as character map bytes
+        AlphabetCJK
+    };
+
+    GXTEnum::eGXTVersion	fileVersion = GXTEnum::eGXTVersion::GXT_SA;
+    size_t					missionTableCount = 8;
+    size_t					entriesPerTable = 1000;
+    // Text lengths in characters, spread evenly or skewed towards short texts with a long tail like real GXT files
+    size_t					minTextLength = 4;
+    size_t					maxTextLength = 64;
+    bool					skewedTextLength = false;
+    // Fraction of the entries that share the TDAT text of an earlier entry
+    double					sharedOffsetRatio = 0.0;
+    // Fraction of the entries the text folder replaces
+    double					replacedRatio = 0.1;
+    eAlphabet				alphabet = AlphabetAscii;
+    uint32_t				seed = 1;
+};
+
+// Generates a valid GXT file, a text folder that replaces some of its entries and a charmap.txt next to the GXT file
+// that covers the alphabet, for scale tests and benchmarks. The tables are MAIN and MIS0001, MIS0002 and so on,
+// the entries are E000000, E000001 and so on. The same settings always produce the same files on every platform.
+class SyntheticGXT
+{
+public:
+    static constexpr size_t	MAX_MISSION_TABLE_COUNT = 9999;
+    static constexpr size_t	MAX_ENTRY_COUNT = 0x1000000;
+
+    // Returns the number of entries the text folder replaces
+    static size_t Generate(const SyntheticGXTSettings& settings, const std::wstring& gxtFileName, const std::wstring& textDirectory);
+};
@@ -0,0 +1,188 @@
+#include "utf16_transcoder.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define UTF16_TRANSCODER_SSE2
+#include <emmintrin.h>
+#endif
+
+// Widens count ASCII (or 8-bit) characters from source into 16-bit little-endian characters at dest
+static void WidenRun(const unsigned char* source, size_t count, char* dest)
+{
+    size_t i = 0;
+#ifdef UTF16_TRANSCODER_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 2), _mm_unpacklo_epi8(chunk, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 2 + 16), _mm_unpackhi_epi8(chunk, zero));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dest[i * 2] = static_cast<char>(source[i]);
+        dest[i * 2 + 1] = 0;
+    }
+}
+
+// Returns the length of the ASCII run at the start of source
+static size_t GetAsciiRunLength(const unsigned char* source, size_t size)
+{
+    size_t i = 0;
+#ifdef UTF16_TRANSCODER_SSE2
+    for (; i + 16 <= size; i += 16)
+    {
+        const int nonAsciiMask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        if (nonAsciiMask != 0)
+        {
+            unsigned long firstNonAscii = 0;
+            while ((nonAsciiMask & (1 << firstNonAscii)) == 0)
+            {
+                firstNonAscii++;
+            }
+            return i + firstNonAscii;
+        }
+    }
+#endif
+    while (i < size && source[i] < 0x80)
+    {
+        i++;
+    }
+    return i;
+}
+
+// Writes the code point as one or two 16-bit units at dest and returns the number of bytes written
+static size_t WriteUtf16(uint32_t codePoint, char* dest)
+{
+    auto writeUnit = [](uint32_t unit, char* unitDest)
+    {
+        unitDest[0] = static_cast<char>(unit & 0xFF);
+        unitDest[1] = static_cast<char>((unit >> 8) & 0xFF);
+    };
+
+    if (codePoint >= 0x10000)
+    {
+        codePoint -= 0x10000;
+        writeUnit(0xD800 + (codePoint >> 10), dest);
+        writeUnit(0xDC00 + (codePoint & 0x3FF), dest + 2);
+        return 4;
+    }
+
+    writeUnit(codePoint, dest);
+    return 2;
+}
+
+std::string Utf16Transcoder::Utf8ToUtf16(const std::string& utf8)
+{
+    const unsigned char* source = reinterpret_cast<const unsigned char*>(utf8.data());
+    const size_t size = utf8.size();
+
+    // Every UTF-8 byte becomes at most one UTF-16 unit, so the output never outgrows this
+    std::string utf16(size * 2, '\0');
+    size_t outputSize = 0;
+
+    size_t i = 0;
+    while (i < size)
+    {
+        const size_t asciiRunLength = GetAsciiRunLength(source + i, size - i);
+        WidenRun(source + i, asciiRunLength, &utf16[outputSize]);
+        i += asciiRunLength;
+        outputSize += asciiRunLength * 2;
+
+        if (i >= size)
+        {
+            break;
+        }
+
+        const unsigned char leadByte = source[i];
+        size_t sequenceLength = 1;
+        uint32_t codePoint = leadByte;
+        if (leadByte >= 0xF0)
+        {
+            sequenceLength = 4;
+            codePoint = leadByte & 0x07;
+        }
+        else if (leadByte >= 0xE0)
+        {
+            sequenceLength = 3;
+            codePoint = leadByte & 0x0F;
+        }
+        else if (leadByte >= 0xC0)
+        {
+            sequenceLength = 2;
+            codePoint = leadByte & 0x1F;
+        }
+
+        if (i + sequenceLength > size)
+        {
+            throw std::runtime_error("Truncated UTF-8 sequence!");
+        }
+        for (size_t j = 1; j < sequenceLength; j++)
+        {
+            codePoint = (codePoint << 6) | (source[i + j] & 0x3F);
+        }
+        i += sequenceLength;
+
+        outputSize += WriteUtf16(codePoint, &utf16[outputSize]);
+    }
+
+    utf16.resize(outputSize);
+    return utf16;
+}
+
+std::string Utf16Transcoder::Utf16ToUtf8(std::string_view utf16)
+{
+    std::string utf8;
+    utf8.reserve(utf16.size());
+
+    const unsigned char* source = reinterpret_cast<const unsigned char*>(utf16.data());
+    const size_t unitCount = utf16.size() / 2;
+    for (size_t i = 0; i < unitCount; i++)
+    {
+        uint32_t codePoint = source[i * 2] | (source[i * 2 + 1] << 8);
+        if (codePoint >= 0xD800 && codePoint < 0xDC00 && i + 1 < unitCount)
+        {
+            const uint32_t lowSurrogate = source[i * 2 + 2] | (source[i * 2 + 3] << 8);
+            if (lowSurrogate >= 0xDC00 && lowSurrogate < 0xE000)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                i++;
+            }
+        }
+
+        if (codePoint < 0x80)
+        {
+            utf8.push_back(static_cast<char>(codePoint));
+        }
+        else if (codePoint < 0x800)
+        {
+            utf8.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+            utf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else if (codePoint < 0x10000)
+        {
+            utf8.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+            utf8.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            utf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+        else
+        {
+            utf8.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+            utf8.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+            utf8.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+            utf8.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    return utf8;
+}
+
+std::string Utf16Transcoder::WidenBytes(const std::string& text)
+{
+    std::string utf16(text.size() * 2, '\0');
+    WidenRun(reinterpret_cast<const unsigned char*>(text.data()), text.size(), &utf16[0]);
+    return utf16;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Converts between UTF-8 and the 16-bit characters of VC and 16-bit SA GXT files.
+// UTF-16 texts are kept as raw little-endian bytes, the way they are stored in TDAT.
+class Utf16Transcoder
+{
+public:
+    // Runs of ASCII characters are widened 16 bytes at a time, other characters are decoded one by one.
+    // The input is expected to be valid UTF-8 (the entry loader rejects invalid files)
+    static std::string Utf8ToUtf16(const std::string& utf8);
+    static std::string Utf16ToUtf8(std::string_view utf16);
+    // Zero-extends every byte of an 8-bit text (ANSI or character map slots) to 16 bits
+    static std::string WidenBytes(const std::string& text);
+};
@@ -28,7 +28,17 @@ DEALINGS IN THE SOFTWARE.
 #ifndef UTF8_FOR_CPP_2675DCD0_9480_4c0c_B92A_CC14C027B731
 #define UTF8_FOR_CPP_2675DCD0_9480_4c0c_B92A_CC14C027B731
 
+// The iterators of the library derive from std::iterator, which C++17 deprecates
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+#endif
+
 #include "utf8/checked.h"
 #include "utf8/unchecked.h"
 
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
 #endif // header guard
@@ -1,74 +1,50 @@
-#include "Crc32keygen.h"
+#include "crc32keygen.h"
 #include "utility.h"
 #include "utf8.h"
+#include "utf16_transcoder.h"
+#include "platform.h"
+#include "build_stats.h"
 
 #include <fstream>
 #include <iostream>
 #include <forward_list>
-#include <Shlwapi.h>
 #include <ctime>
 #include <sstream>
 #include <array>
 #include <vector>
 #include <unordered_map>
+#include <algorithm>
 #include <filesystem>
 
-#include <windows.h>
-#include <io.h>
-#include <fcntl.h>
-
 
 bool Directory::Exists(const std::wstring& dirName_in)
 {
-    DWORD ftyp = GetFileAttributesW(dirName_in.c_str());
-    if (ftyp == INVALID_FILE_ATTRIBUTES)
-        return false;  //something is wrong with your path!
-
-    if (ftyp & FILE_ATTRIBUTE_DIRECTORY)
-        return true;   // this is a directory!
-
-    return false;    // this is not a directory!
+    std::error_code errorCode;
+    return std::filesystem::is_directory(Platform::ToPath(dirName_in), errorCode);
 }
 
 
 std::wstring Encoding::AnsiStringToWString(std::string const& src)
 {
-    int iBufferSize = MultiByteToWideChar(CP_ACP, 0, src.c_str(), -1, (wchar_t*)NULL, 0);
-
-    std::vector<wchar_t> dest(iBufferSize, L'\0');
-
-    MultiByteToWideChar(CP_ACP, 0, src.c_str(), -1, dest.data(), iBufferSize);
-
-    return std::wstring(dest.data(), dest.data() + iBufferSize - 1);
+    return Platform::ToWide(src, Platform::GetAnsiCodePage());
 }
 
-std::wstring Encoding::Utf8ToUtf16(const std::string& utf8)
+std::wstring Encoding::Utf8ToWString(const std::string& utf8)
 {
-    int iBufferSize = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, (wchar_t*)NULL, 0);
-
-    std::vector<wchar_t> dest(iBufferSize, L'\0');
-
-    MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, dest.data(), iBufferSize);
-
-    return std::wstring(dest.data(), dest.data() + iBufferSize - 1);
+    return Platform::ToWide(utf8, Platform::CODE_PAGE_UTF8);
 }
 
 std::string Encoding::Utf8ToAnsi(const std::string& utf8, int ansiCodePage)
 {
-    int lengthUtf16 = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, (wchar_t*)NULL, 0);
-    std::vector<wchar_t> bufUtf16(lengthUtf16, L'\0');
-
-    MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, bufUtf16.data(), lengthUtf16);
-
-    int lengthAnsi = WideCharToMultiByte(ansiCodePage, 0, bufUtf16.data(), -1, NULL, 0, NULL, NULL);
-    std::vector<char> bufAnsi(lengthAnsi, '\0');
-
-    WideCharToMultiByte(ansiCodePage, 0, bufUtf16.data(), lengthUtf16 + 1, bufAnsi.data(), lengthAnsi, NULL, NULL);
+    return Platform::FromWide(Platform::ToWide(utf8, Platform::CODE_PAGE_UTF8), ansiCodePage);
+}
 
-    return std::string(bufAnsi.data(), bufAnsi.data() + lengthAnsi - 1);
+std::string Encoding::AnsiToUtf8(std::string_view ansi, int ansiCodePage)
+{
+    return Platform::FromWide(Platform::ToWide(ansi, ansiCodePage), Platform::CODE_PAGE_UTF8);
 }
 
-void Encoding::MapUtf8StringToAnsi(std::unordered_map<std::string, std::string>& entryMap, int ansiCodePage)
+void Encoding::MapUtf8StringToAnsi(NameEntryMap& entryMap, int ansiCodePage)
 {
     for (auto& pair : entryMap)
     {
@@ -76,7 +52,7 @@ void Encoding::MapUtf8StringToAnsi(std::unordered_map<std::string, std::string>&
         pair.second = ansiString;
     }
 }
-void Encoding::MapUtf8StringToAnsi(std::unordered_map<uint32_t, std::string>& entryMap, int ansiCodePage)
+void Encoding::MapUtf8StringToAnsi(HashEntryMap& entryMap, int ansiCodePage)
 {
     for (auto& pair : entryMap)
     {
@@ -85,49 +61,91 @@ void Encoding::MapUtf8StringToAnsi(std::unordered_map<uint32_t, std::string>& en
     }
 }
 
-std::unordered_map<std::string, std::string> EntryLoader::LoadEntryTextsInDirectory(const std::wstring& textDirectory, std::ofstream& logFile)
+// Text lines are rarely shorter than this, so the total size of the text files bounds the entry count from above
+static const uintmax_t ESTIMATED_LINE_SIZE = 24;
+
+static size_t EstimateEntryCount(const std::wstring& textDirectory)
+{
+    namespace fs = std::filesystem;
+
+    uintmax_t totalSize = 0;
+    for (auto & p : fs::directory_iterator(Platform::ToPath(textDirectory)))
+    {
+        if (p.path().extension() == ".txt")
+        {
+            totalSize += fs::file_size(p.path());
+        }
+    }
+    GXT_STATS_ADD(CounterBytesRead, totalSize);
+    return static_cast<size_t>(totalSize / ESTIMATED_LINE_SIZE);
+}
+
+// Reports names that can't be stored in a GXT file
+static bool IsValidEntryName(const std::string& entryName, const std::wstring& fileName, uint64_t lineCount, DiagnosticLog& log)
+{
+    if (std::any_of(entryName.begin(), entryName.end(), [](char c) { return static_cast<unsigned char>(c) > 0x7e; }))
+    {
+        log.Report(DiagnosticLog::SeverityError, fileName, lineCount, entryName, std::nullopt, "The entry name contains non-ASCII characters! Only ASCII characters can be used for entry names.");
+        return false;
+    }
+    if (entryName.length() >= 8)
+    {
+        log.Report(DiagnosticLog::SeverityError, fileName, lineCount, entryName, std::nullopt, "The entry name is too long! Entry names must be less than 8 characters.");
+        return false;
+    }
+    return true;
+}
+
+NameEntryMap EntryLoader::LoadEntryTextsInDirectory(const std::wstring& textDirectory, DiagnosticLog& log)
 {
-    namespace fs = std::experimental::filesystem::v1;
-    std::unordered_map<std::string, std::string> entryMap;
+    GXT_STATS_TIMER(PhaseScanDirectory);
+    namespace fs = std::filesystem;
+    NameEntryMap entryMap;
+    entryMap.reserve(EstimateEntryCount(textDirectory));
 
-    for (auto & p : fs::directory_iterator(textDirectory))
+    for (auto & p : fs::directory_iterator(Platform::ToPath(textDirectory)))
     {
         if (p.path().extension() == ".txt")
         {            
-            EntryLoader::LoadFileContent(p.path().c_str(), entryMap, logFile);
+            EntryLoader::LoadFileContent(Platform::FromPath(p.path()), entryMap, log);
         }
     }
 
     return entryMap;
 }
 
-std::unordered_map<uint32_t, std::string> EntryLoader::LoadHashEntryTextsInDirectory(const std::wstring& textDirectory, std::ofstream& logFile)
+HashEntryMap EntryLoader::LoadHashEntryTextsInDirectory(const std::wstring& textDirectory, DiagnosticLog& log)
 {
-    namespace fs = std::experimental::filesystem::v1;
-    std::unordered_map<uint32_t, std::string> entryMap;
+    GXT_STATS_TIMER(PhaseScanDirectory);
+    namespace fs = std::filesystem;
+    HashEntryMap entryMap;
+    entryMap.reserve(EstimateEntryCount(textDirectory));
 
-    for (auto & p : fs::directory_iterator(textDirectory))
+    for (auto & p : fs::directory_iterator(Platform::ToPath(textDirectory)))
     {
         if (p.path().extension() == ".txt")
         {
-            EntryLoader::LoadFileContentForHashEntry(p.path().c_str(), entryMap, logFile);
+            EntryLoader::LoadFileContentForHashEntry(Platform::FromPath(p.path()), entryMap, log);
         }
     }
 
     return entryMap;
 }
 
-void EntryLoader::LoadFileContent(const wchar_t* fileName, std::unordered_map<std::string, std::string>& entryMap, std::ofstream& logFile)
+void EntryLoader::LoadFileContent(const std::wstring& fileName, NameEntryMap& entryMap, DiagnosticLog& log)
 {
-    std::ifstream		InputFile(fileName, std::ifstream::in);
+    GXT_STATS_TIMER(PhaseLoadTexts);
+    std::ifstream		InputFile(Platform::ToPath(fileName), std::ifstream::in);
 
     if (InputFile.is_open())
     {
+        GXT_STATS_ADD(CounterFilesOpened, 1);
         std::wcout << L"Reading entries from " << fileName << L"...\n";
 
         if (!Utf8Validator::IsValid(InputFile))
         {
             std::wcerr << L"ERROR: File " << fileName << " contains invalid UTF-8 characters!\n";
+            log.Report(DiagnosticLog::SeverityError, fileName, 0, std::string(), std::nullopt, "The file contains invalid UTF-8 characters and was skipped!");
             return;
         }
 
@@ -144,29 +162,24 @@ void EntryLoader::LoadFileContent(const wchar_t* fileName, std::unordered_map<st
                 if (tabPos == std::string::npos) continue;
 
                 std::string		EntryName(fileLine.begin(), fileLine.begin() + tabPos);
-                std::string		EntryContent(fileLine.begin() + fileLine.find_first_not_of('\t', tabPos), fileLine.end());
-
-                for (char& c : EntryName)
+                std::string		EntryContent;
+                //check if tab position is the last position
+                if (tabPos + 1 != fileLine.size())
                 {
-                    if (c > 0x7e)
-                    {
-                        logFile << L"ERROR: the entry name " << EntryName << " at line " << lineCount << " contains non-ASCII characters! " << "Only ASCII characters can be used for entry names.";
-                        continue;
-                    }
+                    EntryContent = std::string(fileLine.begin() + fileLine.find_first_not_of('\t', tabPos), fileLine.end());
                 }
-                if (EntryName.length() >= 8)
+
+                if (!IsValidEntryName(EntryName, fileName, lineCount, log))
                 {
-                    logFile << L"ERROR: the entry name " << EntryName << " at line " << lineCount << " is too long! " << "Entry names must be less than 8 characters.";
                     continue;
                 }
+                // Entry names are looked up in upper case like the hashed ones
+                std::transform(EntryName.begin(), EntryName.end(), EntryName.begin(), ::toupper);
+
                 // Push entry into table map
-                if (!entryMap.emplace(EntryName, EntryContent).second)
+                if (!entryMap.emplace(FixedName8(EntryName), EntryContent).second)
                 {
-                    if (logFile.is_open())
-                    {
-                        std::wstring wideFileName(fileName);
-                        logFile << "Entry " << EntryName << " duplicated in " << std::string(wideFileName.begin(), wideFileName.end()) << " file!\n";
-                    }
+                    log.Report(DiagnosticLog::SeverityWarning, fileName, lineCount, EntryName, std::nullopt, "The entry is duplicated, the first text is kept.");
                 }
             }
         }
@@ -178,17 +191,20 @@ void EntryLoader::LoadFileContent(const wchar_t* fileName, std::unordered_map<st
     }
 }
 
-void EntryLoader::LoadFileContentForHashEntry(const wchar_t* fileName, std::unordered_map<uint32_t, std::string>& entryMap, std::ofstream& logFile)
+void EntryLoader::LoadFileContentForHashEntry(const std::wstring& fileName, HashEntryMap& entryMap, DiagnosticLog& log)
 {
-    std::ifstream		InputFile(fileName, std::ifstream::in);
+    GXT_STATS_TIMER(PhaseLoadTexts);
+    std::ifstream		InputFile(Platform::ToPath(fileName), std::ifstream::in);
 
     if (InputFile.is_open())
     {
+        GXT_STATS_ADD(CounterFilesOpened, 1);
         std::wcout << L"Reading entries from " << fileName << L"...\n";
 
         if (!Utf8Validator::IsValid(InputFile))
         {
             std::wcerr << L"ERROR: File " << fileName << " contains invalid UTF-8 characters!\n";
+            log.Report(DiagnosticLog::SeverityError, fileName, 0, std::string(), std::nullopt, "The file contains invalid UTF-8 characters and was skipped!");
             return;
         }
 
@@ -225,34 +241,21 @@ void EntryLoader::LoadFileContentForHashEntry(const wchar_t* fileName, std::unor
                         {
                             if (!entryMap.emplace(hexValue.value(), EntryContent).second)
                             {
-                                if (logFile.is_open())
-                                {
-                                    std::wstring wideFileName(fileName);
-                                    logFile << "Entry " << EntryName << " duplicated in " << std::string(wideFileName.begin(), wideFileName.end()) << " file!\n";
-                                }
+                                log.Report(DiagnosticLog::SeverityWarning, fileName, lineCount, EntryName, hexValue, "The entry is duplicated, the first text is kept.");
                             }
 
                             continue;
                         }
                         else
                         {
-                            logFile << L"ERROR: the entry name " << EntryName << " has invalid hex value!\n";
+                            log.Report(DiagnosticLog::SeverityError, fileName, lineCount, EntryName, std::nullopt, "The entry name has an invalid hex value!");
                             continue;
                         }
                     }
                 }
 
-                for (char& c : EntryName)
-                {
-                    if (c > 0x7e)
-                    {
-                        logFile << L"ERROR: the entry name " << EntryName << " at line " << lineCount << " contains non-ASCII characters! " << "Only ASCII characters can be used for entry names.\n";
-                        continue;
-                    }
-                }
-                if (EntryName.length() >= 8)
+                if (!IsValidEntryName(EntryName, fileName, lineCount, log))
                 {
-                    logFile << L"ERROR: the entry name " << EntryName << " at line " << lineCount << " is too long! " << "Entry names must be less than 8 characters.\n";
                     continue;
                 }
 
@@ -261,11 +264,7 @@ void EntryLoader::LoadFileContentForHashEntry(const wchar_t* fileName, std::unor
                 // Push entry into table map
                 if (!entryMap.emplace(entryHash, EntryContent).second)
                 {
-                    if (logFile.is_open())
-                    {
-                        std::wstring wideFileName(fileName);
-                        logFile << "Entry " << EntryName << " duplicated in " << std::string(wideFileName.begin(), wideFileName.end()) << " file!\n";
-                    }
+                    log.Report(DiagnosticLog::SeverityWarning, fileName, lineCount, EntryName, entryHash, "The entry is duplicated, the first text is kept.");
                 }
             }
         }
@@ -294,6 +293,41 @@ std::optional<uint32_t> EntryLoader::HexStringToUInt32(const std::string& hexStr
     }
 }
 
+uint64_t Digest::Compute(const void* data, size_t size, uint64_t digest)
+{
+    const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        digest ^= bytes[i];
+        digest *= FNV_PRIME;
+    }
+    return digest;
+}
+
+uint64_t Digest::Compute(const std::string& str, uint64_t digest)
+{
+    return Compute(str.data(), str.size(), digest);
+}
+
+uint64_t Digest::ComputeFile(const std::wstring& fileName, uint64_t digest)
+{
+    std::ifstream inputFile(Platform::ToPath(fileName), std::ifstream::binary);
+    if (!inputFile.is_open())
+    {
+        throw std::runtime_error("Can't open " + std::string(fileName.begin(), fileName.end()) + "!");
+    }
+    GXT_STATS_ADD(CounterFilesOpened, 1);
+
+    std::array<char, 64 * 1024> buffer;
+    while (inputFile.read(buffer.data(), buffer.size()) || inputFile.gcount() > 0)
+    {
+        digest = Compute(buffer.data(), static_cast<size_t>(inputFile.gcount()), digest);
+    }
+    return digest;
+}
+
 std::vector<std::string> StringExtension::SplitString(const std::string &txt, const char separator, bool allowEmptyString)
 {
     std::vector<std::string> elems;
@@ -341,6 +375,7 @@ std::vector<std::wstring> StringExtension::SplitWString(const std::wstring &txt,
 
 bool Utf8Validator::IsValid(std::ifstream& file)
 {
+    GXT_STATS_TIMER(PhaseValidateUtf8);
     std::istreambuf_iterator<char> it(file.rdbuf());
     std::istreambuf_iterator<char> eos;
     if (!utf8::is_valid(it, eos))
@@ -356,11 +391,12 @@ bool Utf8Validator::IsValid(std::ifstream& file)
 
 CharMapArray CharMap::ParseCharacterMap(const std::wstring& szFileName)
 {
-    std::ifstream		CharMapFile(szFileName, std::ifstream::in);
+    std::ifstream		CharMapFile(Platform::ToPath(szFileName), std::ifstream::in);
     CharMapArray		characterMap;
 
     if (CharMapFile.is_open() && Utf8Validator::IsValid(CharMapFile))
     {
+        GXT_STATS_ADD(CounterFilesOpened, 1);
         CharMapArray::iterator charMapIterator = characterMap.begin();
         for (size_t i = 0; i < CHARACTER_MAP_HEIGHT; ++i)
         {
@@ -388,74 +424,178 @@ CharMapArray CharMap::ParseCharacterMap(const std::wstring& szFileName)
     return characterMap;
 }
 
-void CharMap::ApplyCharacterMap(std::unordered_map<std::string, std::string>& entryMap, const CharMapArray& characterMap)
+std::string CharMap::ApplyCharacterMap(const std::string& text, const CharMapArray& characterMap)
 {
-    for (auto& pair : entryMap)
+    std::string tempStr;
+    utf8::iterator<std::string::const_iterator> strIt(text.begin(), text.begin(), text.end());
+    for (; strIt.base() != text.end(); ++strIt)
     {
-        std::string tempStr;
-        utf8::iterator<std::string::iterator> strIt(pair.second.begin(), pair.second.begin(), pair.second.end());
-        for (; strIt.base() != pair.second.end(); ++strIt)
+        bool	found = false;
+        if (*strIt == '\0')
         {
-            bool	found = false;
-            if (*strIt == '\0')
-            {
-                tempStr.push_back('\0');
-                continue;
-            }
-            for (size_t i = 0; i < CHARACTER_MAP_SIZE; ++i)
+            tempStr.push_back('\0');
+            continue;
+        }
+        for (size_t i = 0; i < CHARACTER_MAP_SIZE; ++i)
+        {
+            if (*strIt == characterMap[i])
             {
-                if (*strIt == characterMap[i])
-                {
-                    tempStr.push_back(static_cast<char>(i + 32)); //Character map currently supports 16 * 14 chars 
-                    found = true;
-                    break;
-                }
+                tempStr.push_back(static_cast<char>(i + 32)); //Character map currently supports 16 * 14 chars 
+                found = true;
+                break;
             }
+        }
 
-            if (!found)
-            {
-                std::ostringstream tmpstream;
-                tmpstream << "Can't locate character \"" << static_cast<wchar_t>(*strIt) << "\" (" << *strIt << ") in a character map!";
-                throw std::runtime_error(tmpstream.str());
-            }
+        if (!found)
+        {
+            std::ostringstream tmpstream;
+            tmpstream << "Can't locate character \"" << static_cast<wchar_t>(*strIt) << "\" (" << *strIt << ") in a character map!";
+            throw std::runtime_error(tmpstream.str());
         }
+    }
+
+    return tempStr;
+}
 
-        pair.second = tempStr;
+void CharMap::ApplyCharacterMap(NameEntryMap& entryMap, const CharMapArray& characterMap)
+{
+    GXT_STATS_TIMER(PhaseApplyCharacterMap);
+    for (auto& pair : entryMap)
+    {
+        pair.second = ApplyCharacterMap(pair.second, characterMap);
     }
 }
-void CharMap::ApplyCharacterMap(std::unordered_map<uint32_t, std::string>& entryMap, const CharMapArray& characterMap)
+void CharMap::ApplyCharacterMap(HashEntryMap& entryMap, const CharMapArray& characterMap)
 {
+    GXT_STATS_TIMER(PhaseApplyCharacterMap);
     for (auto& pair : entryMap)
     {
-        std::string tempStr;
-        utf8::iterator<std::string::iterator> strIt(pair.second.begin(), pair.second.begin(), pair.second.end());
-        for (;strIt.base() != pair.second.end(); ++strIt)
+        pair.second = ApplyCharacterMap(pair.second, characterMap);
+    }
+}
+
+std::string CharMap::RevertCharacterMap(std::string_view text, const CharMapArray& characterMap)
+{
+    std::string utf8Str;
+    utf8Str.reserve(text.size());
+
+    for (char c : text)
+    {
+        const size_t slot = static_cast<unsigned char>(c);
+        if (slot >= 32 && slot - 32 < CHARACTER_MAP_SIZE)
         {
-            bool	found = false;
-            if (*strIt == '\0')
-            {
-                tempStr.push_back('\0');
-                continue;
-            }
-            for (size_t i = 0; i < CHARACTER_MAP_SIZE; ++i)
+            utf8::append(characterMap[slot - 32], std::back_inserter(utf8Str));
+        }
+        else
+        {
+            utf8Str.push_back(c);
+        }
+    }
+
+    return utf8Str;
+}
+
+TextConverter::TextConverter(GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage, const std::wstring& charMapFileName)
+    : _textConvertingMode(textConvertingMode), _ansiCodePage(ansiCodePage)
+{
+    if (textConvertingMode == GXTEnum::eTextConvertingMode::UseCharacterMap)
+    {
+        _charMap = CharMap::ParseCharacterMap(charMapFileName);
+    }
+}
+
+template<typename Map>
+void TextConverter::ConvertFromUtf8Impl(Map& entryMap, size_t characterSize) const
+{
+    GXT_STATS_TIMER(PhaseConvertEncoding);
+    switch (_textConvertingMode)
+    {
+        case GXTEnum::eTextConvertingMode::UseCharacterMap:
+        {
+            CharMap::ApplyCharacterMap(entryMap, _charMap.value());
+        }
+            break;
+        case GXTEnum::eTextConvertingMode::UseAnsi:
+        {
+            Encoding::MapUtf8StringToAnsi(entryMap, _ansiCodePage);
+        }
+            break;
+        default:
+        {
+            if (characterSize == sizeof(uint16_t))
             {
-                if (*strIt == characterMap[i])
+                for (auto& pair : entryMap)
                 {
-                    tempStr.push_back(static_cast<char>(i + 32)); //Character map currently supports 16 * 14 chars 
-                    found = true;
-                    break;
+                    pair.second = Utf16Transcoder::Utf8ToUtf16(pair.second);
                 }
             }
+        }
+            return;
+    }
 
-            if (!found)
-            {
-                std::ostringstream tmpstream;
-                tmpstream << "Can't locate character \"" << static_cast<wchar_t>(*strIt) << "\" (" << *strIt << ") in a character map!";
-                throw std::runtime_error(tmpstream.str());
-            }
+    if (characterSize == sizeof(uint16_t))
+    {
+        for (auto& pair : entryMap)
+        {
+            pair.second = Utf16Transcoder::WidenBytes(pair.second);
         }
+    }
+}
 
-        pair.second = tempStr;
+void TextConverter::ConvertFromUtf8(HashEntryMap& entryMap, size_t characterSize) const
+{
+    ConvertFromUtf8Impl(entryMap, characterSize);
+}
+
+void TextConverter::ConvertFromUtf8(NameEntryMap& entryMap, size_t characterSize) const
+{
+    ConvertFromUtf8Impl(entryMap, characterSize);
+}
+
+std::string TextConverter::ConvertFromUtf8(const std::string& text, size_t characterSize) const
+{
+    std::string convertedText;
+    switch (_textConvertingMode)
+    {
+        case GXTEnum::eTextConvertingMode::UseCharacterMap:
+            convertedText = CharMap::ApplyCharacterMap(text, _charMap.value());
+            break;
+        case GXTEnum::eTextConvertingMode::UseAnsi:
+            convertedText = Encoding::Utf8ToAnsi(text, _ansiCodePage);
+            break;
+        default:
+            return characterSize == sizeof(uint16_t) ? Utf16Transcoder::Utf8ToUtf16(text) : text;
     }
+
+    return characterSize == sizeof(uint16_t) ? Utf16Transcoder::WidenBytes(convertedText) : convertedText;
 }
 
+std::string TextConverter::ConvertToUtf8(std::string_view text, size_t characterSize) const
+{
+    if (characterSize == sizeof(uint16_t))
+    {
+        if (_textConvertingMode == GXTEnum::eTextConvertingMode::UseUtf8OrUtf16)
+        {
+            return Utf16Transcoder::Utf16ToUtf8(text);
+        }
+
+        // Only the low bytes carry ANSI or character map slots
+        std::string narrowText;
+        narrowText.reserve(text.size() / 2);
+        for (size_t i = 0; i + 1 < text.size(); i += 2)
+        {
+            narrowText.push_back(text[i]);
+        }
+        return ConvertToUtf8(narrowText);
+    }
+
+    switch (_textConvertingMode)
+    {
+        case GXTEnum::eTextConvertingMode::UseCharacterMap:
+            return CharMap::RevertCharacterMap(text, _charMap.value());
+        case GXTEnum::eTextConvertingMode::UseAnsi:
+            return Encoding::AnsiToUtf8(text, _ansiCodePage);
+        default:
+            return std::string(text);
+    }
+}
@@ -1,12 +1,12 @@
 #pragma once
 
 #include "gxt_text_replacer.h"
+#include "diagnostic_log.h"
 
 #include <string>
+#include <string_view>
 #include <map>
 #include <memory>
-#include <strsafe.h>
-#include <intrin.h>
 #include <unordered_map>
 #include <optional>
 #include <any>
@@ -21,22 +21,21 @@ class Encoding
 {
 public:
     static std::wstring AnsiStringToWString(std::string const& src);
-    static std::wstring Utf8ToUtf16(const std::string& utf8);
+    static std::wstring Utf8ToWString(const std::string& utf8);
     static std::string Utf8ToAnsi(const std::string& utf8, int ansiCodePage);
+    static std::string AnsiToUtf8(std::string_view ansi, int ansiCodePage);
 
-    static void MapUtf8StringToAnsi(std::unordered_map<std::string, std::string>& map, int ansiCodePage);
-    static void MapUtf8StringToAnsi(std::unordered_map<uint32_t, std::string>& map, int ansiCodePage);
+    static void MapUtf8StringToAnsi(NameEntryMap& map, int ansiCodePage);
+    static void MapUtf8StringToAnsi(HashEntryMap& map, int ansiCodePage);
 };
 
 class EntryLoader
 {
 public:
-    static std::unordered_map<std::string, std::string> LoadEntryTextsInDirectory(const std::wstring& textDirectory, std::ofstream& logFile);
-    static std::unordered_map<uint32_t, std::string> LoadHashEntryTextsInDirectory(const std::wstring& textDirectory, std::ofstream& logFile);
-    static void LoadFileContent(const wchar_t* fileName, std::unordered_map<std::string, std::string>& entryMap, std::ofstream& logFile);
-    static void LoadFileContentForHashEntry(const wchar_t* fileName, std::unordered_map<uint32_t, std::string>& entryMap, std::ofstream& logFile);
-
-private:
+    static NameEntryMap LoadEntryTextsInDirectory(const std::wstring& textDirectory, DiagnosticLog& log);
+    static HashEntryMap LoadHashEntryTextsInDirectory(const std::wstring& textDirectory, DiagnosticLog& log);
+    static void LoadFileContent(const std::wstring& fileName, NameEntryMap& entryMap, DiagnosticLog& log);
+    static void LoadFileContentForHashEntry(const std::wstring& fileName, HashEntryMap& entryMap, DiagnosticLog& log);
     static std::optional<uint32_t> HexStringToUInt32(const std::string& hexString);
 };
 
@@ -46,6 +45,17 @@ public:
     static bool IsValid(std::ifstream& file);
 };
 
+// 64-bit FNV-1a digest used to detect changed inputs between runs
+class Digest
+{
+public:
+    static const uint64_t INITIAL_VALUE = 0xcbf29ce484222325ULL;
+
+    static uint64_t Compute(const void* data, size_t size, uint64_t digest = INITIAL_VALUE);
+    static uint64_t Compute(const std::string& str, uint64_t digest = INITIAL_VALUE);
+    static uint64_t ComputeFile(const std::wstring& fileName, uint64_t digest = INITIAL_VALUE);
+};
+
 class StringExtension
 {
 public:
@@ -63,8 +73,44 @@ typedef std::array<uint32_t, CHARACTER_MAP_SIZE> CharMapArray;
 class CharMap
 {
 public:
-    static void ApplyCharacterMap(std::unordered_map<std::string, std::string>& entryMap, const CharMapArray& characterMap);
-    static void ApplyCharacterMap(std::unordered_map<uint32_t, std::string>& entryMap, const CharMapArray& characterMap);
+    static void ApplyCharacterMap(NameEntryMap& entryMap, const CharMapArray& characterMap);
+    static void ApplyCharacterMap(HashEntryMap& entryMap, const CharMapArray& characterMap);
+    static std::string ApplyCharacterMap(const std::string& text, const CharMapArray& characterMap);
     static CharMapArray ParseCharacterMap(const std::wstring& szFileName);
+    // Maps character map slots back to UTF-8
+    static std::string RevertCharacterMap(std::string_view text, const CharMapArray& characterMap);
+};
+
+// Converts entry texts between UTF-8 and the GXT text encoding with one set of settings.
+// The character map is parsed once when the converter is created.
+class TextConverter
+{
+public:
+    TextConverter(GXTEnum::eTextConvertingMode textConvertingMode, int ansiCodePage, const std::wstring& charMapFileName = L"charmap.txt");
+
+    GXTEnum::eTextConvertingMode GetTextConvertingMode() const
+    {
+        return _textConvertingMode;
+    }
+    int GetAnsiCodePage() const
+    {
+        return _ansiCodePage;
+    }
+
+    // characterSize is the TDAT character size of the target table, 16-bit tables get UTF-16 texts with -unicodetext
+    // and zero-extended ANSI or character map bytes otherwise
+    void ConvertFromUtf8(HashEntryMap& entryMap, size_t characterSize = 1) const;
+    void ConvertFromUtf8(NameEntryMap& entryMap, size_t characterSize = 1) const;
+    // The same for one text, throws std::runtime_error like the map versions if a character isn't in the character map
+    std::string ConvertFromUtf8(const std::string& text, size_t characterSize = 1) const;
+    std::string ConvertToUtf8(std::string_view text, size_t characterSize = 1) const;
+
+private:
+    template<typename Map>
+    void ConvertFromUtf8Impl(Map& entryMap, size_t characterSize) const;
+
+    GXTEnum::eTextConvertingMode	_textConvertingMode;
+    int								_ansiCodePage;
+    std::optional<CharMapArray>		_charMap;
 };
 
@@ -0,0 +1,440 @@
+#include "gxt_text_replacer.h"
+#include "gxt_table.h"
+#include "synthetic_gxt.h"
+#include "utility.h"
+#include "crc32keygen.h"
+#include "platform.h"
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+#include <unordered_map>
+#include <algorithm>
+
+// Run with --benchmark_format=json (or --benchmark_out=file --benchmark_out_format=json) to compare releases.
+// Every input is made by SyntheticGXT from a fixed seed, so runs on the same machine measure the same data.
+
+namespace
+{
+    const uint32_t	RANDOM_SEED = 0x47585421;
+    const double	SHARED_OFFSET_RATIO = 0.05;
+    const int		ANSI_CODE_PAGE = 1252;
+
+    // An 8-bit SA file of missionTableCount mission tables of entriesPerTable entries each, with some entries sharing
+    // their text like in the game's files
+    SyntheticGXTSettings MakeSettings(size_t missionTableCount, size_t entriesPerTable)
+    {
+        SyntheticGXTSettings settings;
+        settings.missionTableCount = missionTableCount;
+        settings.entriesPerTable = entriesPerTable;
+        settings.sharedOffsetRatio = SHARED_OFFSET_RATIO;
+        settings.seed = RANDOM_SEED;
+        return settings;
+    }
+
+    // Settings whose text folder has one text of exactly length characters for every one of entryCount entries
+    SyntheticGXTSettings MakeTextSettings(size_t entryCount, size_t length, SyntheticGXTSettings::eAlphabet alphabet)
+    {
+        SyntheticGXTSettings settings = MakeSettings(0, entryCount);
+        settings.minTextLength = length;
+        settings.maxTextLength = length;
+        settings.replacedRatio = 1.0;
+        settings.alphabet = alphabet;
+        return settings;
+    }
+
+    // A generated GXT file and text folder in the temp folder, removed with the object
+    class GeneratedGXT
+    {
+    public:
+        GeneratedGXT(const std::string& name, const SyntheticGXTSettings& settings)
+            : _directory(std::filesystem::temp_directory_path() / ("gxt_benchmark_" + name))
+        {
+            std::filesystem::remove_all(_directory);
+            std::filesystem::create_directories(_directory);
+            _replacedCount = SyntheticGXT::Generate(settings, GetFileName(), GetTextDirectory());
+        }
+
+        ~GeneratedGXT()
+        {
+            std::error_code errorCode;
+            std::filesystem::remove_all(_directory, errorCode);
+        }
+
+        GeneratedGXT(const GeneratedGXT&) = delete;
+        GeneratedGXT& operator=(const GeneratedGXT&) = delete;
+
+        std::wstring GetFileName() const
+        {
+            return Platform::FromPath(_directory / "generated.gxt");
+        }
+
+        std::wstring GetTextDirectory() const
+        {
+            return Platform::FromPath(_directory / "texts");
+        }
+
+        // The text file replacing entries of the main table, it doesn't exist if no entry is replaced
+        std::wstring GetMainTextFileName() const
+        {
+            return Platform::FromPath(_directory / "texts" / "MAIN" / "generated.txt");
+        }
+
+        std::wstring GetCharacterMapFileName() const
+        {
+            return Platform::FromPath(_directory / "charmap.txt");
+        }
+
+        int64_t GetFileSize() const
+        {
+            return static_cast<int64_t>(std::filesystem::file_size(_directory / "generated.gxt"));
+        }
+
+        int64_t GetMainTextFileSize() const
+        {
+            return static_cast<int64_t>(std::filesystem::file_size(_directory / "texts" / "MAIN" / "generated.txt"));
+        }
+
+        size_t GetReplacedCount() const
+        {
+            return _replacedCount;
+        }
+
+    private:
+        std::filesystem::path	_directory;
+        size_t					_replacedCount = 0;
+    };
+
+    // The UTF-8 texts of the main table's text file in file order
+    std::vector<std::string> LoadMainTexts(const GeneratedGXT& generated)
+    {
+        std::ifstream file(Platform::ToPath(generated.GetMainTextFileName()), std::ifstream::in);
+        std::vector<std::string> texts;
+        std::string fileLine;
+        while (std::getline(file, fileLine))
+        {
+            const std::string::size_type tabPos = fileLine.find('\t');
+            if (tabPos != std::string::npos)
+            {
+                texts.push_back(fileLine.substr(tabPos + 1));
+            }
+        }
+        return texts;
+    }
+
+    // The entries of the main table's text file keyed like the replacer keys SA and VC entries
+    void LoadMainEntries(const GeneratedGXT& generated, std::vector<std::pair<uint32_t, std::string>>& entries)
+    {
+        DiagnosticLog log;
+        HashEntryMap entryMap;
+        EntryLoader::LoadFileContentForHashEntry(generated.GetMainTextFileName(), entryMap, log);
+        for (const auto& entry : entryMap)
+        {
+            entries.push_back(entry);
+        }
+    }
+
+    void LoadMainEntries(const GeneratedGXT& generated, std::vector<std::pair<FixedName8, std::string>>& entries)
+    {
+        DiagnosticLog log;
+        NameEntryMap entryMap;
+        EntryLoader::LoadFileContent(generated.GetMainTextFileName(), entryMap, log);
+        for (const auto& entry : entryMap)
+        {
+            entries.push_back(entry);
+        }
+    }
+}
+
+// Args: mission table count, entries per table
+static void BM_ReadGXTFile(benchmark::State& state)
+{
+    const GeneratedGXT generated("read", MakeSettings(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1))));
+
+    for (auto _ : state)
+    {
+        auto tableCollection = ReadGXTFile(generated.GetFileName(), GXTEnum::eGXTVersion::GXT_SA);
+        benchmark::DoNotOptimize(tableCollection);
+    }
+
+    state.SetBytesProcessed(state.iterations() * generated.GetFileSize());
+    state.SetItemsProcessed(state.iterations() * (state.range(0) + 1) * state.range(1));
+}
+BENCHMARK(BM_ReadGXTFile)->Args({ 0, 1 << 12 })->Args({ 0, 1 << 16 })->Args({ 64, 1 << 10 })->Args({ 512, 1 << 8 })->Unit(benchmark::kMillisecond);
+
+// Arg: entry count
+static void BM_ReadTKEYAndTDATBlock(benchmark::State& state)
+{
+    const GeneratedGXT generated("table", MakeSettings(0, static_cast<size_t>(state.range(0))));
+    const uint32_t tableOffset = ReadGXTFile(generated.GetFileName(), GXTEnum::eGXTVersion::GXT_SA)->GetMainTable()._absoluteOffset;
+    std::ifstream file(Platform::ToPath(generated.GetFileName()), std::ifstream::binary);
+
+    for (auto _ : state)
+    {
+        auto table = GXTTableBase::InstantiateGXTTable(GXTEnum::eGXTVersion::GXT_SA);
+        benchmark::DoNotOptimize(table->ReadTKEYAndTDATBlock(file, tableOffset));
+    }
+
+    state.SetBytesProcessed(state.iterations() * (generated.GetFileSize() - tableOffset));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReadTKEYAndTDATBlock)->RangeMultiplier(16)->Range(1 << 8, 1 << 20)->Unit(benchmark::kMicrosecond);
+
+// Args: entry count, replaced entries in per mille, GXTEnum::eReplaceStrategy. The counters are per replaced entry and byte.
+// The entry counts around GXTTable::SORT_MERGE_MIN_ENTRIES show where the sort-merge starts to win.
+static void BM_ReplaceEntries(benchmark::State& state)
+{
+    SyntheticGXTSettings settings = MakeSettings(0, static_cast<size_t>(state.range(0)));
+    settings.replacedRatio = state.range(1) / 1000.0;
+    const GeneratedGXT generated("replace", settings);
+
+    auto originalTable = ReadGXTFile(generated.GetFileName(), GXTEnum::eGXTVersion::GXT_SA)->GetMainTable()._GXTTable->Clone();
+    originalTable->SetReplaceStrategy(static_cast<GXTEnum::eReplaceStrategy>(state.range(2)));
+
+    // The generated texts are ASCII, so they are the same in UTF-8 and in the 8-bit table
+    DiagnosticLog log;
+    HashEntryMap entryMap;
+    if (generated.GetReplacedCount() != 0)
+    {
+        EntryLoader::LoadFileContentForHashEntry(generated.GetMainTextFileName(), entryMap, log);
+    }
+
+    size_t replacedBytes = 0;
+    for (const auto& pair : entryMap)
+    {
+        replacedBytes += pair.second.size();
+    }
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto table = originalTable->Clone();
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(table->ReplaceEntries(entryMap));
+
+        state.PauseTiming();
+        table.reset();
+        state.ResumeTiming();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(replacedBytes));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(entryMap.size()));
+}
+BENCHMARK(BM_ReplaceEntries)
+    ->ArgsProduct({ { 1 << 6, 1 << 7, 1 << 8, 1 << 9, 1 << 10, 1 << 14, 1 << 18 }, { 1, 10, 100, 500, 1000 }, { GXTEnum::eReplaceStrategy::ReplaceHashProbe, GXTEnum::eReplaceStrategy::ReplaceSortMerge } })
+    ->ArgNames({ "entries", "permille", "strategy" })
+    ->Unit(benchmark::kMicrosecond);
+
+// Arg: entry count. The entry maps against std::unordered_map with the same keys and texts, filled in the same order.
+template<typename Key, typename Map>
+static void BM_EntryMapInsert(benchmark::State& state)
+{
+    const GeneratedGXT generated("map_insert", MakeTextSettings(static_cast<size_t>(state.range(0)), 48, SyntheticGXTSettings::AlphabetAscii));
+    std::vector<std::pair<Key, std::string>> entries;
+    LoadMainEntries(generated, entries);
+
+    for (auto _ : state)
+    {
+        Map entryMap;
+        for (const auto& entry : entries)
+        {
+            entryMap.emplace(entry.first, entry.second);
+        }
+        benchmark::DoNotOptimize(entryMap.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(entries.size()));
+}
+BENCHMARK_TEMPLATE(BM_EntryMapInsert, uint32_t, HashEntryMap)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_EntryMapInsert, uint32_t, std::unordered_map<uint32_t, std::string>)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_EntryMapInsert, FixedName8, NameEntryMap)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_EntryMapInsert, FixedName8, std::unordered_map<FixedName8, std::string>)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// Arg: entry count. Every entry is looked up once per iteration, in an order unrelated to the one it was inserted in.
+template<typename Key, typename Map>
+static void BM_EntryMapFind(benchmark::State& state)
+{
+    const GeneratedGXT generated("map_find", MakeTextSettings(static_cast<size_t>(state.range(0)), 48, SyntheticGXTSettings::AlphabetAscii));
+    std::vector<std::pair<Key, std::string>> entries;
+    LoadMainEntries(generated, entries);
+
+    Map entryMap;
+    for (const auto& entry : entries)
+    {
+        entryMap.emplace(entry.first, entry.second);
+    }
+    std::reverse(entries.begin(), entries.end());
+
+    for (auto _ : state)
+    {
+        size_t textBytes = 0;
+        for (const auto& entry : entries)
+        {
+            textBytes += entryMap.find(entry.first)->second.size();
+        }
+        benchmark::DoNotOptimize(textBytes);
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(entries.size()));
+}
+BENCHMARK_TEMPLATE(BM_EntryMapFind, uint32_t, HashEntryMap)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_EntryMapFind, uint32_t, std::unordered_map<uint32_t, std::string>)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_EntryMapFind, FixedName8, NameEntryMap)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_EntryMapFind, FixedName8, std::unordered_map<FixedName8, std::string>)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+// Args: mission table count, entries per table
+static void BM_WriteGXTFile(benchmark::State& state)
+{
+    const GeneratedGXT generated("write", MakeSettings(static_cast<size_t>(state.range(0)), static_cast<size_t>(state.range(1))));
+    const std::wstring outputFileName = Platform::FromPath(std::filesystem::temp_directory_path() / "gxt_benchmark_write_output.gxt");
+    auto tableCollection = ReadGXTFile(generated.GetFileName(), GXTEnum::eGXTVersion::GXT_SA);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(tableCollection->WriteGXTFile(outputFileName));
+    }
+
+    state.SetBytesProcessed(state.iterations() * generated.GetFileSize());
+    state.SetItemsProcessed(state.iterations() * (state.range(0) + 1) * state.range(1));
+    std::filesystem::remove(Platform::ToPath(outputFileName));
+}
+BENCHMARK(BM_WriteGXTFile)->Args({ 0, 1 << 16 })->Args({ 64, 1 << 10 })->Unit(benchmark::kMillisecond);
+
+// Args: entry count, SyntheticGXTSettings::eAlphabet
+static void BM_LoadFileContentForHashEntry(benchmark::State& state)
+{
+    const GeneratedGXT generated("entries", MakeTextSettings(static_cast<size_t>(state.range(0)), 48, static_cast<SyntheticGXTSettings::eAlphabet>(state.range(1))));
+    DiagnosticLog log;
+
+    for (auto _ : state)
+    {
+        HashEntryMap entryMap;
+        EntryLoader::LoadFileContentForHashEntry(generated.GetMainTextFileName(), entryMap, log);
+        benchmark::DoNotOptimize(entryMap.size());
+    }
+
+    state.SetBytesProcessed(state.iterations() * generated.GetMainTextFileSize());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LoadFileContentForHashEntry)
+    ->ArgsProduct({ { 1 << 10, 1 << 16 }, { SyntheticGXTSettings::AlphabetAscii, SyntheticGXTSettings::AlphabetLatin1 } })
+    ->ArgNames({ "entries", "alphabet" })
+    ->Unit(benchmark::kMicrosecond);
+
+// Args: text length, SyntheticGXTSettings::eAlphabet
+static void BM_Utf8ToAnsi(benchmark::State& state)
+{
+    const GeneratedGXT generated("ansi", MakeTextSettings(1, static_cast<size_t>(state.range(0)), static_cast<SyntheticGXTSettings::eAlphabet>(state.range(1))));
+    const std::string text = LoadMainTexts(generated).at(0);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(Encoding::Utf8ToAnsi(text, ANSI_CODE_PAGE));
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Utf8ToAnsi)
+    ->ArgsProduct({ { 16, 256, 4096 }, { SyntheticGXTSettings::AlphabetAscii, SyntheticGXTSettings::AlphabetLatin1 } })
+    ->ArgNames({ "length", "alphabet" });
+
+// Args: entry count, SyntheticGXTSettings::eAlphabet. The generated charmap.txt covers the alphabet.
+static void BM_ApplyCharacterMap(benchmark::State& state)
+{
+    const GeneratedGXT generated("charmap", MakeTextSettings(static_cast<size_t>(state.range(0)), 48, static_cast<SyntheticGXTSettings::eAlphabet>(state.range(1))));
+    const CharMapArray characterMap = CharMap::ParseCharacterMap(generated.GetCharacterMapFileName());
+
+    DiagnosticLog log;
+    HashEntryMap originalEntryMap;
+    EntryLoader::LoadFileContentForHashEntry(generated.GetMainTextFileName(), originalEntryMap, log);
+
+    size_t textBytes = 0;
+    for (const auto& pair : originalEntryMap)
+    {
+        textBytes += pair.second.size();
+    }
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        HashEntryMap entryMap = originalEntryMap;
+        state.ResumeTiming();
+
+        CharMap::ApplyCharacterMap(entryMap, characterMap);
+
+        state.PauseTiming();
+        entryMap = HashEntryMap();
+        state.ResumeTiming();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(textBytes));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(originalEntryMap.size()));
+}
+BENCHMARK(BM_ApplyCharacterMap)
+    ->ArgsProduct({ { 1 << 10, 1 << 14 }, { SyntheticGXTSettings::AlphabetAscii, SyntheticGXTSettings::AlphabetLatin1, SyntheticGXTSettings::AlphabetCJK } })
+    ->ArgNames({ "entries", "alphabet" })
+    ->Unit(benchmark::kMicrosecond);
+
+// Args: entry count of the validated text file, SyntheticGXTSettings::eAlphabet
+static void BM_Utf8ValidatorIsValid(benchmark::State& state)
+{
+    const GeneratedGXT generated("utf8", MakeTextSettings(static_cast<size_t>(state.range(0)), 48, static_cast<SyntheticGXTSettings::eAlphabet>(state.range(1))));
+    std::ifstream file(Platform::ToPath(generated.GetMainTextFileName()), std::ifstream::binary);
+
+    for (auto _ : state)
+    {
+        file.clear();
+        file.seekg(0, std::ios_base::beg);
+        benchmark::DoNotOptimize(Utf8Validator::IsValid(file));
+    }
+
+    state.SetBytesProcessed(state.iterations() * generated.GetMainTextFileSize());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Utf8ValidatorIsValid)
+    ->ArgsProduct({ { 1 << 6, 1 << 14 }, { SyntheticGXTSettings::AlphabetAscii, SyntheticGXTSettings::AlphabetLatin1, SyntheticGXTSettings::AlphabetCJK } })
+    ->ArgNames({ "entries", "alphabet" })
+    ->Unit(benchmark::kMicrosecond);
+
+// Arg: key length
+static void BM_GetUppercaseKey(benchmark::State& state)
+{
+    const GeneratedGXT generated("keys", MakeTextSettings(1024, static_cast<size_t>(state.range(0)), SyntheticGXTSettings::AlphabetAscii));
+    const std::vector<std::string> keys = LoadMainTexts(generated);
+    size_t keyBytes = 0;
+    for (const auto& key : keys)
+    {
+        keyBytes += key.size();
+    }
+
+    for (auto _ : state)
+    {
+        for (const auto& key : keys)
+        {
+            benchmark::DoNotOptimize(Crc32KeyGen::GetUppercaseKey(key.c_str()));
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(keyBytes));
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(keys.size()));
+}
+BENCHMARK(BM_GetUppercaseKey)->Arg(4)->Arg(8)->Arg(16);
+
+int main(int argc, char** argv)
+{
+    // The loaders and writers report progress on std::wcout, only the benchmark results go to std::cout
+    std::wcout.setstate(std::ios_base::badbit);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,252 @@
+// Builds of a generated SA file with the build cache, overwriting the file like the replacer does: a table is spliced
+// from the cache only while its texts, the character map, the settings and its source bytes are unchanged, the output is
+// the same as without the cache, and tables whose texts have problems are rebuilt and logged every time.
+// Run as "gxt_build_cache_tests (in_place, restored_source, text_edit, charmap_edit, settings_change or diagnostics)".
+#include "test_helpers.h"
+#include "gxt_text_replacer.h"
+#include "build_cache.h"
+#include "synthetic_gxt.h"
+#include "diagnostic_log.h"
+#include "utility.h"
+
+#include <vector>
+#include <optional>
+#include <algorithm>
+
+namespace
+{
+    struct BuildSettings
+    {
+        GXTEnum::eTextConvertingMode	textConvMode = GXTEnum::eTextConvertingMode::UseAnsi;
+        int								ansiCodePage = 1252;
+    };
+
+    struct BuildResult
+    {
+        std::vector<std::string>	splicedTables;
+        uint64_t					recordCount = 0;
+    };
+
+    struct CacheCase
+    {
+        const char*		name;
+        bool			(*run)(const std::wstring& directory);
+    };
+
+    const size_t MISSION_TABLE_COUNT = 3;
+
+    std::wstring GetFileName(const std::wstring& directory, const wchar_t* name)
+    {
+        return directory + Platform::PATH_SEPARATOR + name;
+    }
+
+    // Builds gxtFileName in place like the replacer, with the cache next to it if useCache is set
+    BuildResult Build(const std::wstring& gxtFileName, const std::wstring& textDirectory, const BuildSettings& settings, bool useCache)
+    {
+        std::optional<BuildCache> buildCache;
+        if (useCache)
+        {
+            buildCache.emplace(gxtFileName + L".cache", textDirectory, GXTEnum::eGXTVersion::GXT_SA, settings.textConvMode, settings.ansiCodePage);
+            buildCache->Load();
+        }
+
+        DiagnosticLog log;
+        auto tableCollection = ReadGXTFile(gxtFileName, GXTEnum::eGXTVersion::GXT_SA, buildCache ? &buildCache.value() : nullptr);
+        std::wstring textSourceDirectory = textDirectory;
+        tableCollection->BulkReplaceText(textSourceDirectory, settings.textConvMode, settings.ansiCodePage, log, buildCache ? &buildCache.value() : nullptr);
+        tableCollection->WriteGXTFile(gxtFileName);
+
+        BuildResult result;
+        auto addTable = [&](const GXTTableBlockInfo& tableInfo)
+        {
+            if (tableInfo.IsSpliced())
+            {
+                result.splicedTables.push_back(tableInfo._tableName.ToString());
+            }
+            result.recordCount += log.GetRecordCount(tableInfo._tableName.ToString());
+        };
+        addTable(tableCollection->GetMainTable());
+        for (const auto& missionTable : tableCollection->GetMissionTableMap())
+        {
+            addTable(*missionTable.second);
+        }
+
+        if (buildCache)
+        {
+            buildCache->Update(*tableCollection, log);
+            buildCache->Save();
+        }
+        return result;
+    }
+
+    // Generates source.gxt and its texts into directory and copies source.gxt to replaced.gxt, which the builds overwrite
+    bool Generate(const std::wstring& directory)
+    {
+        SyntheticGXTSettings settings;
+        settings.missionTableCount = MISSION_TABLE_COUNT;
+        settings.entriesPerTable = 1000;
+        settings.sharedOffsetRatio = 0.1;
+        settings.replacedRatio = 0.3;
+        TEST_CHECK(SyntheticGXT::Generate(settings, GetFileName(directory, L"source.gxt"), GetFileName(directory, L"texts")) > 0);
+
+        std::filesystem::copy_file(Platform::ToPath(GetFileName(directory, L"source.gxt")), Platform::ToPath(GetFileName(directory, L"replaced.gxt")));
+        return true;
+    }
+
+    // The bytes a build of source.gxt without the cache writes
+    std::string BuildReference(const std::wstring& directory, const BuildSettings& settings)
+    {
+        const std::wstring referenceFileName = GetFileName(directory, L"reference.gxt");
+        std::filesystem::copy_file(Platform::ToPath(GetFileName(directory, L"source.gxt")), Platform::ToPath(referenceFileName), std::filesystem::copy_options::overwrite_existing);
+        Build(referenceFileName, GetFileName(directory, L"texts"), settings, false);
+        return TestHelpers::ReadFileBytes(referenceFileName);
+    }
+
+    // Overwrites the text of the first entry in the text file of the table
+    void EditFirstText(const std::wstring& directory, const std::string& tableName, const std::string& text)
+    {
+        const std::filesystem::path textFileName = Platform::ToPath(GetFileName(directory, L"texts")) / tableName / "generated.txt";
+        std::string content = TestHelpers::ReadFileBytes(Platform::FromPath(textFileName));
+        const size_t textStart = content.find('\t') + 1;
+        content.replace(textStart, content.find('\n') - textStart, text);
+        std::ofstream(textFileName, std::ofstream::binary) << content;
+    }
+
+    bool RunInPlace(const std::wstring& directory)
+    {
+        const std::wstring gxtFileName = GetFileName(directory, L"replaced.gxt");
+        const std::wstring textDirectory = GetFileName(directory, L"texts");
+
+        TEST_CHECK(Build(gxtFileName, textDirectory, BuildSettings(), true).splicedTables.empty());
+        const std::string builtBytes = TestHelpers::ReadFileBytes(gxtFileName);
+        TEST_CHECK(builtBytes == BuildReference(directory, BuildSettings()));
+
+        // The source is now the output of the last build
+        TEST_CHECK(Build(gxtFileName, textDirectory, BuildSettings(), true).splicedTables.size() == MISSION_TABLE_COUNT + 1);
+        TEST_CHECK(TestHelpers::ReadFileBytes(gxtFileName) == builtBytes);
+        return true;
+    }
+
+    bool RunRestoredSource(const std::wstring& directory)
+    {
+        const std::wstring gxtFileName = GetFileName(directory, L"replaced.gxt");
+        const std::wstring textDirectory = GetFileName(directory, L"texts");
+
+        TEST_CHECK(Build(gxtFileName, textDirectory, BuildSettings(), true).splicedTables.empty());
+        const std::string builtBytes = TestHelpers::ReadFileBytes(gxtFileName);
+
+        // The source is the original file again, the cached output blocks are written instead of its tables
+        std::filesystem::copy_file(Platform::ToPath(GetFileName(directory, L"source.gxt")), Platform::ToPath(gxtFileName), std::filesystem::copy_options::overwrite_existing);
+        TEST_CHECK(Build(gxtFileName, textDirectory, BuildSettings(), true).splicedTables.size() == MISSION_TABLE_COUNT + 1);
+        TEST_CHECK(TestHelpers::ReadFileBytes(gxtFileName) == builtBytes);
+        return true;
+    }
+
+    bool RunTextEdit(const std::wstring& directory)
+    {
+        const std::wstring gxtFileName = GetFileName(directory, L"replaced.gxt");
+        const std::wstring textDirectory = GetFileName(directory, L"texts");
+
+        TEST_CHECK(Build(gxtFileName, textDirectory, BuildSettings(), true).splicedTables.empty());
+
+        EditFirstText(directory, "MIS0002", "Edited text");
+        const BuildResult result = Build(gxtFileName, textDirectory, BuildSettings(), true);
+        TEST_CHECK(result.splicedTables.size() == MISSION_TABLE_COUNT);
+        TEST_CHECK(std::find(result.splicedTables.begin(), result.splicedTables.end(), "MIS0002") == result.splicedTables.end());
+        TEST_CHECK(TestHelpers::ReadFileBytes(gxtFileName) == BuildReference(directory, BuildSettings()));
+        return true;
+    }
+
+    bool RunCharmapEdit(const std::wstring& directory)
+    {
+        const std::wstring gxtFileName = GetFileName(directory, L"replaced.gxt");
+        const std::wstring textDirectory = GetFileName(directory, L"texts");
+        const std::wstring charMapFileName = GetFileName(directory, L"charmap.txt");
+
+        // The character map is read from the working directory, so the builds run in the folder the generator wrote it to
+        std::filesystem::current_path(Platform::ToPath(directory));
+        BuildSettings settings;
+        settings.textConvMode = GXTEnum::eTextConvertingMode::UseCharacterMap;
+
+        TEST_CHECK(Build(gxtFileName, textDirectory, settings, true).splicedTables.empty());
+        TEST_CHECK(Build(gxtFileName, textDirectory, settings, true).splicedTables.size() == MISSION_TABLE_COUNT + 1);
+
+        // Swapping two letters moves them to each other's slot
+        std::string charMap = TestHelpers::ReadFileBytes(charMapFileName);
+        const size_t aPos = charMap.find('a');
+        const size_t bPos = charMap.find('b');
+        std::swap(charMap[aPos], charMap[bPos]);
+        std::ofstream(Platform::ToPath(charMapFileName), std::ofstream::binary) << charMap;
+
+        TEST_CHECK(Build(gxtFileName, textDirectory, settings, true).splicedTables.empty());
+        TEST_CHECK(TestHelpers::ReadFileBytes(gxtFileName) == BuildReference(directory, settings));
+        return true;
+    }
+
+    bool RunSettingsChange(const std::wstring& directory)
+    {
+        const std::wstring gxtFileName = GetFileName(directory, L"replaced.gxt");
+        const std::wstring textDirectory = GetFileName(directory, L"texts");
+
+        TEST_CHECK(Build(gxtFileName, textDirectory, BuildSettings(), true).splicedTables.empty());
+
+        BuildSettings changedSettings;
+        changedSettings.ansiCodePage = 1250;
+        TEST_CHECK(Build(gxtFileName, textDirectory, changedSettings, true).splicedTables.empty());
+        TEST_CHECK(Build(gxtFileName, textDirectory, changedSettings, true).splicedTables.size() == MISSION_TABLE_COUNT + 1);
+        return true;
+    }
+
+    bool RunDiagnostics(const std::wstring& directory)
+    {
+        const std::wstring gxtFileName = GetFileName(directory, L"replaced.gxt");
+        const std::wstring textDirectory = GetFileName(directory, L"texts");
+
+        {
+            std::ofstream textFile(Platform::ToPath(textDirectory) / "MIS0001" / "generated.txt", std::ofstream::binary | std::ofstream::app);
+            textFile << "TOOLONGNAME\tNever replaced\n";
+        }
+
+        const BuildResult firstResult = Build(gxtFileName, textDirectory, BuildSettings(), true);
+        TEST_CHECK(firstResult.splicedTables.empty());
+        TEST_CHECK(firstResult.recordCount == 1);
+
+        // The other tables are spliced, the one with the problem is loaded and logs it again
+        const BuildResult secondResult = Build(gxtFileName, textDirectory, BuildSettings(), true);
+        TEST_CHECK(secondResult.splicedTables.size() == MISSION_TABLE_COUNT);
+        TEST_CHECK(std::find(secondResult.splicedTables.begin(), secondResult.splicedTables.end(), "MIS0001") == secondResult.splicedTables.end());
+        TEST_CHECK(secondResult.recordCount == 1);
+        TEST_CHECK(TestHelpers::ReadFileBytes(gxtFileName) == BuildReference(directory, BuildSettings()));
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // The loaders and writers report progress on std::wcout
+    std::wcout.setstate(std::ios_base::badbit);
+
+    const CacheCase testCases[] =
+    {
+        { "in_place", RunInPlace },
+        { "restored_source", RunRestoredSource },
+        { "text_edit", RunTextEdit },
+        { "charmap_edit", RunCharmapEdit },
+        { "settings_change", RunSettingsChange },
+        { "diagnostics", RunDiagnostics },
+    };
+
+    bool passed = true;
+    bool ran = false;
+    for (const auto& testCase : testCases)
+    {
+        if (argc < 2 || std::string(argv[1]) == testCase.name)
+        {
+            std::cout << "Build cache test " << testCase.name << "\n";
+            const std::wstring directory = TestHelpers::MakeEmptyDirectory(std::string("build_cache_") + testCase.name);
+            passed = Generate(directory) && testCase.run(directory) && passed;
+            ran = true;
+        }
+    }
+    return passed && ran ? 0 : 1;
+}
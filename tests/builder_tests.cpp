@@ -0,0 +1,84 @@
+// Builds of generated VC, SA and 16-bit SA files without shared texts: extracting the file and building it back from a
+// project listing the extracted folders gives the same bytes. Run as "gxt_builder_tests (vc, sa or sa16)".
+#include "test_helpers.h"
+#include "gxt_text_replacer.h"
+#include "gxt_extractor.h"
+#include "gxt_builder.h"
+#include "synthetic_gxt.h"
+#include "diagnostic_log.h"
+#include "utility.h"
+
+namespace
+{
+    struct BuildCase
+    {
+        const char*						name;
+        GXTEnum::eGXTVersion			fileVersion;
+        GXTEnum::eTextConvertingMode	textConvMode;
+    };
+
+    bool RunBuild(const BuildCase& testCase)
+    {
+        const std::wstring directory = TestHelpers::MakeEmptyDirectory(std::string("builder_") + testCase.name);
+        const std::wstring gxtFileName = directory + Platform::PATH_SEPARATOR + L"original.gxt";
+        const std::wstring textDirectory = directory + Platform::PATH_SEPARATOR + L"texts";
+        const std::wstring extractedDirectory = directory + Platform::PATH_SEPARATOR + L"extracted";
+        const std::wstring iniFileName = directory + Platform::PATH_SEPARATOR + L"project.ini";
+        const std::wstring builtFileName = directory + Platform::PATH_SEPARATOR + L"built.gxt";
+
+        // The builder lays out every text once in key order, like the generator does without shared offsets
+        SyntheticGXTSettings settings;
+        settings.fileVersion = testCase.fileVersion;
+        settings.missionTableCount = 3;
+        settings.entriesPerTable = 2000;
+        settings.sharedOffsetRatio = 0.0;
+        settings.alphabet = SyntheticGXTSettings::AlphabetLatin1;
+        SyntheticGXT::Generate(settings, gxtFileName, textDirectory);
+
+        const TextConverter textConverter(testCase.textConvMode, 1252);
+        DiagnosticLog log;
+
+        // The main table comes first, then the mission tables
+        auto tableCollection = ReadGXTFile(gxtFileName, testCase.fileVersion);
+        TEST_CHECK(GXTExtractor::Extract(*tableCollection, extractedDirectory, textConverter, log) > 0);
+        {
+            std::ofstream iniFile(Platform::ToPath(iniFileName));
+            iniFile << "[Attribs]\nversion=" << testCase.name << "\n\n[Tables]\n";
+            iniFile << "extracted/" << tableCollection->GetMainTable()._tableName.ToString() << "\n";
+            for (const auto& missionTable : tableCollection->GetMissionTableMap())
+            {
+                iniFile << "extracted/" << missionTable.first.ToString() << "\n";
+            }
+        }
+
+        const GXTProject project = GXTProject::Load(iniFileName);
+        TEST_CHECK(project.fileVersion == testCase.fileVersion);
+        auto builtCollection = GXTBuilder::Build(project, project.fileVersion.value(), textConverter, log);
+        TEST_CHECK(builtCollection->WriteGXTFile(builtFileName));
+        TEST_CHECK(TestHelpers::ReadFileBytes(builtFileName) == TestHelpers::ReadFileBytes(gxtFileName));
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const BuildCase testCases[] =
+    {
+        { "vc", GXTEnum::eGXTVersion::GXT_VC, GXTEnum::eTextConvertingMode::UseUtf8OrUtf16 },
+        { "sa", GXTEnum::eGXTVersion::GXT_SA, GXTEnum::eTextConvertingMode::UseAnsi },
+        { "sa16", GXTEnum::eGXTVersion::GXT_SA_16BIT, GXTEnum::eTextConvertingMode::UseUtf8OrUtf16 },
+    };
+
+    bool passed = true;
+    bool ran = false;
+    for (const auto& testCase : testCases)
+    {
+        if (argc < 2 || std::string(argv[1]) == testCase.name)
+        {
+            std::cout << "Build of " << testCase.name << "\n";
+            passed = RunBuild(testCase) && passed;
+            ran = true;
+        }
+    }
+    return passed && ran ? 0 : 1;
+}
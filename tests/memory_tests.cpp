@@ -0,0 +1,94 @@
+// Heap use of a build of a generated SA file: with -stats counting the allocations, reading, replacing and writing must
+// stay under a multiple of the input size in every phase, so a phase that starts copying the whole file again fails.
+// Run as "gxt_memory_tests".
+#include "test_helpers.h"
+#include "gxt_text_replacer.h"
+#include "synthetic_gxt.h"
+#include "build_stats.h"
+#include "diagnostic_log.h"
+#include "utility.h"
+
+#include <filesystem>
+
+namespace
+{
+    // Limits in multiples of the GXT file and text folder size, about a quarter above what GCC 12 with glibc measures.
+    // A phase's peak includes what earlier phases still hold, like the read tables. Validating UTF-8 doesn't allocate.
+    struct PhaseLimit
+    {
+        BuildStats::ePhase	phase;
+        const char*			name;
+        double				inputMultiple;
+    };
+
+    const PhaseLimit PHASE_LIMITS[] =
+    {
+        { BuildStats::PhaseReadGXT, "read", 1.25 },
+        { BuildStats::PhaseScanDirectory, "scan", 2.0 },
+        { BuildStats::PhaseLoadTexts, "load", 2.0 },
+        { BuildStats::PhaseConvertEncoding, "encode", 2.0 },
+        { BuildStats::PhaseReplaceEntries, "replace", 2.25 },
+        { BuildStats::PhaseWriteGXT, "write", 2.0 },
+    };
+
+    uint64_t GetDirectorySize(const std::wstring& directory)
+    {
+        uint64_t size = 0;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(Platform::ToPath(directory)))
+        {
+            if (entry.is_regular_file())
+            {
+                size += entry.file_size();
+            }
+        }
+        return size;
+    }
+
+    bool RunBuild()
+    {
+        const std::wstring directory = TestHelpers::MakeEmptyDirectory("memory");
+        const std::wstring gxtFileName = directory + Platform::PATH_SEPARATOR + L"original.gxt";
+        const std::wstring textDirectory = directory + Platform::PATH_SEPARATOR + L"texts";
+        const std::wstring outputFileName = directory + Platform::PATH_SEPARATOR + L"replaced.gxt";
+
+        SyntheticGXTSettings settings;
+        settings.missionTableCount = 16;
+        settings.entriesPerTable = 4000;
+        settings.skewedTextLength = true;
+        settings.maxTextLength = 256;
+        settings.sharedOffsetRatio = 0.05;
+        settings.replacedRatio = 0.5;
+        TEST_CHECK(SyntheticGXT::Generate(settings, gxtFileName, textDirectory) > 0);
+
+        const uint64_t inputSize = std::filesystem::file_size(Platform::ToPath(gxtFileName)) + GetDirectorySize(textDirectory);
+
+        BuildStats::Enable();
+        {
+            const TextConverter textConverter(GXTEnum::eTextConvertingMode::UseAnsi, 1252);
+            DiagnosticLog log;
+            auto tableCollection = ReadGXTFile(gxtFileName, GXTEnum::eGXTVersion::GXT_SA);
+            tableCollection->BulkReplaceText(textDirectory, textConverter, log);
+            TEST_CHECK(tableCollection->WriteGXTFile(outputFileName));
+        }
+        BuildStats::PrintReport(std::cout);
+
+        std::cout << "\nInput bytes: " << inputSize << "\n";
+        for (const auto& phaseLimit : PHASE_LIMITS)
+        {
+            const int64_t peakBytes = BuildStats::GetPeakHeapBytes(phaseLimit.phase);
+            const int64_t limitBytes = static_cast<int64_t>(phaseLimit.inputMultiple * inputSize);
+            std::cout << phaseLimit.name << ": peak " << peakBytes << " bytes, limit " << limitBytes << " bytes\n";
+            TEST_CHECK(peakBytes > 0);
+            TEST_CHECK(peakBytes <= limitBytes);
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    // The loaders and writers report progress on std::wcout, only the report goes to std::cout
+    std::wcout.setstate(std::ios_base::badbit);
+
+    return RunBuild() ? 0 : 1;
+}
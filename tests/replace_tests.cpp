@@ -0,0 +1,154 @@
+// Replacing the entries of one generated table in different ways must write the same TKEY and TDAT bytes: probing the
+// entry map or sort-merging it, and rebuilding TDAT serially or in chunks. Run as "gxt_replace_tests (strategies or
+// parallel_rebuild)".
+#include "test_helpers.h"
+#include "gxt_text_replacer.h"
+#include "synthetic_gxt.h"
+#include "diagnostic_log.h"
+#include "utility.h"
+
+#include <functional>
+#include <sstream>
+
+namespace
+{
+    struct GeneratedTable
+    {
+        std::unique_ptr<GXTTableBase>	table;
+        // The converted texts of the text folder, the map the table is keyed with is filled
+        HashEntryMap					hashEntries;
+        NameEntryMap					nameEntries;
+    };
+
+    struct ReplaceCase
+    {
+        const char*		name;
+        bool			(*run)();
+    };
+
+    const GXTEnum::eGXTVersion FILE_VERSIONS[] = { GXTEnum::eGXTVersion::GXT_VC, GXTEnum::eGXTVersion::GXT_SA, GXTEnum::eGXTVersion::GXT_SA_16BIT };
+
+    // Generates a file whose main table has entryCount entries and loads the table and the texts replacing it
+    bool GenerateTable(const std::string& name, GXTEnum::eGXTVersion fileVersion, size_t entryCount, double replacedRatio, GeneratedTable& generated)
+    {
+        const std::wstring directory = TestHelpers::MakeEmptyDirectory(name);
+        const std::wstring gxtFileName = directory + Platform::PATH_SEPARATOR + L"original.gxt";
+        const std::wstring textDirectory = directory + Platform::PATH_SEPARATOR + L"texts";
+
+        SyntheticGXTSettings settings;
+        settings.fileVersion = fileVersion;
+        settings.missionTableCount = 0;
+        settings.entriesPerTable = entryCount;
+        settings.sharedOffsetRatio = 0.2;
+        settings.replacedRatio = replacedRatio;
+        const size_t replacedCount = SyntheticGXT::Generate(settings, gxtFileName, textDirectory);
+
+        generated.table = ReadGXTFile(gxtFileName, fileVersion)->GetMainTable()._GXTTable->Clone();
+        TEST_CHECK(generated.table->GetNumEntries() == entryCount);
+        if (replacedCount == 0)
+        {
+            return true;
+        }
+
+        // The generated texts are ASCII, so the ANSI conversion only widens them for 16-bit tables
+        const std::wstring textFileName = textDirectory + Platform::PATH_SEPARATOR + L"MAIN" + Platform::PATH_SEPARATOR + L"generated.txt";
+        const TextConverter textConverter(GXTEnum::eTextConvertingMode::UseAnsi, 1252);
+        const size_t characterSize = generated.table->GetCharacterSize();
+        DiagnosticLog log;
+        if (generated.table->UsesHashForEntryName())
+        {
+            EntryLoader::LoadFileContentForHashEntry(textFileName, generated.hashEntries, log);
+            textConverter.ConvertFromUtf8(generated.hashEntries, characterSize);
+            TEST_CHECK(generated.hashEntries.size() == replacedCount);
+        }
+        else
+        {
+            EntryLoader::LoadFileContent(textFileName, generated.nameEntries, log);
+            textConverter.ConvertFromUtf8(generated.nameEntries, characterSize);
+            TEST_CHECK(generated.nameEntries.size() == replacedCount);
+        }
+        return true;
+    }
+
+    // Replaces the texts in a copy of the table set up by configure and returns the written TKEY and TDAT blocks
+    std::string ReplaceAndWrite(const GeneratedTable& generated, const std::function<void(GXTTableBase&)>& configure)
+    {
+        auto table = generated.table->Clone();
+        configure(*table);
+        if (table->UsesHashForEntryName())
+        {
+            table->ReplaceEntries(generated.hashEntries);
+        }
+        else
+        {
+            table->ReplaceEntries(generated.nameEntries);
+        }
+
+        std::ostringstream stream;
+        table->WriteTKEYAndTDATBlock(stream);
+        return stream.str();
+    }
+
+    // Table sizes on both sides of GXTTable::SORT_MERGE_MIN_ENTRIES, so ReplaceAuto picks each strategy
+    bool RunStrategies()
+    {
+        const GXTEnum::eReplaceStrategy strategies[] = { GXTEnum::eReplaceStrategy::ReplaceSortMerge, GXTEnum::eReplaceStrategy::ReplaceAuto };
+        for (const auto fileVersion : FILE_VERSIONS)
+        {
+            for (const size_t entryCount : { 300, 1023, 1024, 5000 })
+            {
+                for (const double replacedRatio : { 0.01, 0.1, 0.5, 1.0 })
+                {
+                    GeneratedTable generated;
+                    TEST_CHECK(GenerateTable("strategies", fileVersion, entryCount, replacedRatio, generated));
+
+                    const std::string probedBytes = ReplaceAndWrite(generated, [](GXTTableBase& table) { table.SetReplaceStrategy(GXTEnum::eReplaceStrategy::ReplaceHashProbe); });
+                    for (const auto strategy : strategies)
+                    {
+                        TEST_CHECK(ReplaceAndWrite(generated, [&](GXTTableBase& table) { table.SetReplaceStrategy(strategy); }) == probedBytes);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Uneven chunk counts and more chunks than cores give the chunks different sizes and run some of them on one thread
+    bool RunParallelRebuild()
+    {
+        for (const auto fileVersion : FILE_VERSIONS)
+        {
+            GeneratedTable generated;
+            TEST_CHECK(GenerateTable("parallel_rebuild", fileVersion, 120000, 0.3, generated));
+
+            const std::string serialBytes = ReplaceAndWrite(generated, [](GXTTableBase& table) { table.SetRebuildChunkCount(1); });
+            for (const size_t chunkCount : { 2, 3, 16 })
+            {
+                TEST_CHECK(ReplaceAndWrite(generated, [&](GXTTableBase& table) { table.SetRebuildChunkCount(chunkCount); }) == serialBytes);
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const ReplaceCase testCases[] =
+    {
+        { "strategies", RunStrategies },
+        { "parallel_rebuild", RunParallelRebuild },
+    };
+
+    bool passed = true;
+    bool ran = false;
+    for (const auto& testCase : testCases)
+    {
+        if (argc < 2 || std::string(argv[1]) == testCase.name)
+        {
+            std::cout << "Replace test " << testCase.name << "\n";
+            passed = testCase.run() && passed;
+            ran = true;
+        }
+    }
+    return passed && ran ? 0 : 1;
+}
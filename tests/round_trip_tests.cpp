@@ -0,0 +1,191 @@
+// Round trips of generated VC, SA and 16-bit SA files: reading and writing gives the same bytes, replacing writes a
+// file whose entries read back as the replaced or the original texts, and replacing with an extracted folder gives
+// the same bytes again. Run as "gxt_round_trip_tests (vc, sa, sa16, vc_cjk or sa16_cjk)".
+#include "test_helpers.h"
+#include "gxt_text_replacer.h"
+#include "gxt_extractor.h"
+#include "synthetic_gxt.h"
+#include "diagnostic_log.h"
+#include "utility.h"
+
+#include <vector>
+#include <map>
+#include <cstdio>
+
+namespace
+{
+    struct RoundTripCase
+    {
+        const char*						name;
+        GXTEnum::eGXTVersion			fileVersion;
+        GXTEnum::eTextConvertingMode	textConvMode;
+        SyntheticGXTSettings::eAlphabet	alphabet;
+    };
+
+    std::vector<GXTTableBlockInfo*> GetTables(GXTTableCollection& tableCollection)
+    {
+        std::vector<GXTTableBlockInfo*> tables{ &tableCollection.GetMainTable() };
+        for (auto& missionTable : tableCollection.GetMissionTableMap())
+        {
+            tables.push_back(missionTable.second.get());
+        }
+        return tables;
+    }
+
+    bool FindEntryContent(const GXTTableBase& table, const std::string& entryName, std::string& content)
+    {
+        if (table.UsesHashForEntryName())
+        {
+            const auto hash = EntryLoader::HexStringToUInt32(entryName.substr(2));
+            return hash && table.FindEntryContent(hash.value(), content);
+        }
+        return table.FindEntryContent(FixedName8(entryName), content);
+    }
+
+    // The converted texts of the text folder of a table, keyed like ForEachEntry names the entries
+    std::map<std::string, std::string> LoadReplacedTexts(const GXTTableBlockInfo& tableInfo, const std::wstring& textDirectory, const TextConverter& textConverter, DiagnosticLog& log)
+    {
+        const std::wstring tableDirectory = textDirectory + Platform::PATH_SEPARATOR + Encoding::AnsiStringToWString(tableInfo._tableName.ToString());
+        const size_t characterSize = tableInfo._GXTTable->GetCharacterSize();
+
+        std::map<std::string, std::string> replacedTexts;
+        if (tableInfo._GXTTable->UsesHashForEntryName())
+        {
+            auto entryMap = EntryLoader::LoadHashEntryTextsInDirectory(tableDirectory, log);
+            textConverter.ConvertFromUtf8(entryMap, characterSize);
+            for (const auto& entryPair : entryMap)
+            {
+                char entryName[11];
+                std::snprintf(entryName, sizeof(entryName), "0x%08X", entryPair.first);
+                replacedTexts.emplace(entryName, entryPair.second);
+            }
+        }
+        else
+        {
+            auto entryMap = EntryLoader::LoadEntryTextsInDirectory(tableDirectory, log);
+            textConverter.ConvertFromUtf8(entryMap, characterSize);
+            for (const auto& entryPair : entryMap)
+            {
+                replacedTexts.emplace(entryPair.first.ToString(), entryPair.second);
+            }
+        }
+        return replacedTexts;
+    }
+
+    bool RunRoundTrip(const RoundTripCase& testCase)
+    {
+        const std::wstring directory = TestHelpers::MakeEmptyDirectory(std::string("round_trip_") + testCase.name);
+        const std::wstring gxtFileName = directory + Platform::PATH_SEPARATOR + L"original.gxt";
+        const std::wstring textDirectory = directory + Platform::PATH_SEPARATOR + L"texts";
+
+        SyntheticGXTSettings settings;
+        settings.fileVersion = testCase.fileVersion;
+        settings.missionTableCount = 3;
+        settings.entriesPerTable = 2000;
+        settings.sharedOffsetRatio = 0.2;
+        settings.replacedRatio = 0.3;
+        settings.alphabet = testCase.alphabet;
+        TEST_CHECK(SyntheticGXT::Generate(settings, gxtFileName, textDirectory) > 0);
+
+        const std::string originalBytes = TestHelpers::ReadFileBytes(gxtFileName);
+        const TextConverter textConverter(testCase.textConvMode, 1252);
+        DiagnosticLog log;
+
+        // Read, write, compare
+        {
+            const std::wstring copyFileName = directory + Platform::PATH_SEPARATOR + L"copy.gxt";
+            auto tableCollection = ReadGXTFile(gxtFileName, testCase.fileVersion);
+            TEST_CHECK(tableCollection->WriteGXTFile(copyFileName));
+            TEST_CHECK(TestHelpers::ReadFileBytes(copyFileName) == originalBytes);
+        }
+
+        // Replace, re-read, compare every entry with the replaced or the original text
+        {
+            const std::wstring replacedFileName = directory + Platform::PATH_SEPARATOR + L"replaced.gxt";
+            auto original = ReadGXTFile(gxtFileName, testCase.fileVersion);
+            auto tableCollection = ReadGXTFile(gxtFileName, testCase.fileVersion);
+            tableCollection->BulkReplaceText(textDirectory, textConverter, log);
+            TEST_CHECK(tableCollection->WriteGXTFile(replacedFileName));
+            TEST_CHECK(TestHelpers::ReadFileBytes(replacedFileName).size() == tableCollection->ComputeFileSize());
+
+            auto replaced = ReadGXTFile(replacedFileName, testCase.fileVersion);
+            const auto originalTables = GetTables(*original);
+            const auto replacedTables = GetTables(*replaced);
+            TEST_CHECK(originalTables.size() == replacedTables.size());
+
+            size_t replacedCount = 0;
+            for (size_t i = 0; i < originalTables.size(); i++)
+            {
+                const GXTTableBase& originalTable = *originalTables[i]->_GXTTable;
+                const GXTTableBase& replacedTable = *replacedTables[i]->_GXTTable;
+                TEST_CHECK(originalTables[i]->_tableName == replacedTables[i]->_tableName);
+                TEST_CHECK(originalTable.GetNumEntries() == replacedTable.GetNumEntries());
+
+                const auto replacedTexts = LoadReplacedTexts(*originalTables[i], textDirectory, textConverter, log);
+                bool allFound = true;
+                bool allMatch = true;
+                originalTable.ForEachEntry([&](const std::string& entryName, std::string_view originalContent)
+                {
+                    std::string content;
+                    if (!FindEntryContent(replacedTable, entryName, content))
+                    {
+                        allFound = false;
+                        return;
+                    }
+
+                    auto itr = replacedTexts.find(entryName);
+                    if (itr != replacedTexts.end())
+                    {
+                        allMatch = allMatch && content == itr->second;
+                        replacedCount++;
+                    }
+                    else
+                    {
+                        allMatch = allMatch && content == originalContent;
+                    }
+                });
+                TEST_CHECK(allFound);
+                TEST_CHECK(allMatch);
+            }
+            TEST_CHECK(replacedCount > 0);
+        }
+
+        // Extract, replace with the extracted folder, compare
+        {
+            const std::wstring extractedDirectory = directory + Platform::PATH_SEPARATOR + L"extracted";
+            const std::wstring rebuiltFileName = directory + Platform::PATH_SEPARATOR + L"rebuilt.gxt";
+            auto tableCollection = ReadGXTFile(gxtFileName, testCase.fileVersion);
+            TEST_CHECK(GXTExtractor::Extract(*tableCollection, extractedDirectory, textConverter, log) > 0);
+            tableCollection->BulkReplaceText(extractedDirectory, textConverter, log);
+            TEST_CHECK(tableCollection->WriteGXTFile(rebuiltFileName));
+            TEST_CHECK(TestHelpers::ReadFileBytes(rebuiltFileName) == originalBytes);
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const RoundTripCase testCases[] =
+    {
+        { "vc", GXTEnum::eGXTVersion::GXT_VC, GXTEnum::eTextConvertingMode::UseUtf8OrUtf16, SyntheticGXTSettings::AlphabetLatin1 },
+        { "sa", GXTEnum::eGXTVersion::GXT_SA, GXTEnum::eTextConvertingMode::UseAnsi, SyntheticGXTSettings::AlphabetLatin1 },
+        { "sa16", GXTEnum::eGXTVersion::GXT_SA_16BIT, GXTEnum::eTextConvertingMode::UseUtf8OrUtf16, SyntheticGXTSettings::AlphabetLatin1 },
+        { "vc_cjk", GXTEnum::eGXTVersion::GXT_VC, GXTEnum::eTextConvertingMode::UseUtf8OrUtf16, SyntheticGXTSettings::AlphabetCJK },
+        { "sa16_cjk", GXTEnum::eGXTVersion::GXT_SA_16BIT, GXTEnum::eTextConvertingMode::UseUtf8OrUtf16, SyntheticGXTSettings::AlphabetCJK },
+    };
+
+    bool passed = true;
+    bool ran = false;
+    for (const auto& testCase : testCases)
+    {
+        if (argc < 2 || std::string(argv[1]) == testCase.name)
+        {
+            std::cout << "Round trip of " << testCase.name << "\n";
+            passed = RunRoundTrip(testCase) && passed;
+            ran = true;
+        }
+    }
+    return passed && ran ? 0 : 1;
+}
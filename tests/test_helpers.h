@@ -0,0 +1,30 @@
+#pragma once
+
+#include "platform.h"
+
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <string>
+
+// The tests are plain executables run by ctest, a failed check prints where it failed and the test returns 1
+#define TEST_CHECK(condition) do { if (!(condition)) { std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n"; return false; } } while ( false )
+
+namespace TestHelpers
+{
+    // An empty folder in the temp folder, left behind for inspecting failures
+    inline std::wstring MakeEmptyDirectory(const std::string& name)
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "gxt_tests" / name;
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory);
+        return Platform::FromPath(directory);
+    }
+
+    inline std::string ReadFileBytes(const std::wstring& fileName)
+    {
+        std::ifstream file(Platform::ToPath(fileName), std::ifstream::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
@@ -0,0 +1,51 @@
+// Utf16Transcoder turns UTF-8 into the little-endian UTF-16 bytes of 16-bit tables and back, characters outside the
+// BMP as surrogate pairs. Run as "gxt_utf16_tests".
+#include "test_helpers.h"
+#include "utf16_transcoder.h"
+
+namespace
+{
+    struct TranscodingCase
+    {
+        const char*		description;
+        std::string		utf8;
+        std::string		utf16;
+    };
+
+    bool RunTranscoding()
+    {
+        // The ASCII runs of 16 characters and more are widened in blocks, so the other characters follow one too
+        const std::string asciiRun = "Sixteen+ ASCII characters: ";
+        std::string widenedAsciiRun;
+        for (const char c : asciiRun)
+        {
+            widenedAsciiRun += c;
+            widenedAsciiRun += '\0';
+        }
+
+        const TranscodingCase testCases[] =
+        {
+            { "ASCII", "A", std::string("A\0", 2) },
+            { "two bytes", "\xC3\xA9", std::string("\xE9\0", 2) },
+            { "three bytes", "\xE6\xBC\xA2", "\x22\x6F" },
+            { "U+1F600", "\xF0\x9F\x98\x80", std::string("\x3D\xD8\x00\xDE", 4) },
+            { "U+20000", "\xF0\xA0\x80\x80", std::string("\x40\xD8\x00\xDC", 4) },
+            { "U+10FFFF", "\xF4\x8F\xBF\xBF", "\xFF\xDB\xFF\xDF" },
+            { "surrogate pair after an ASCII run", asciiRun + "\xF0\x9F\x98\x80!", widenedAsciiRun + std::string("\x3D\xD8\x00\xDE!\0", 6) },
+            { "mixed", "a\xE6\xBC\xA2\xF0\xA0\x80\x80\xC3\xA9", std::string("a\0\x22\x6F\x40\xD8\x00\xDC\xE9\0", 10) },
+        };
+
+        for (const auto& testCase : testCases)
+        {
+            std::cout << testCase.description << "\n";
+            TEST_CHECK(Utf16Transcoder::Utf8ToUtf16(testCase.utf8) == testCase.utf16);
+            TEST_CHECK(Utf16Transcoder::Utf16ToUtf8(testCase.utf16) == testCase.utf8);
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    return RunTranscoding() ? 0 : 1;
+}